@@ -16,16 +16,23 @@ SOURCES += main.cpp\
     mainwindow.cpp \
     mainview.cpp \
     user_input.cpp \
-    model.cpp \
-    utility.cpp
+    latencytracker.cpp \
+    renderwindow.cpp \
+    renderthread.cpp \
+    gridview.cpp \
+    softwareview.cpp
 
 HEADERS  += mainwindow.h \
     mainview.h \
-    model.h \
-    vertex.h \
-    disk.h
+    latencytracker.h \
+    gameview.h \
+    renderwindow.h \
+    renderthread.h \
+    snapshotbuffer.h \
+    gridview.h \
+    softwareview.h
 
 FORMS    += mainwindow.ui
 
-RESOURCES += \
-    resources.qrc
+include(scene.pri)
+include(engine.pri)
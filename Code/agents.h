@@ -0,0 +1,290 @@
+#ifndef AGENTS_H
+#define AGENTS_H
+
+#include "jobsystem.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+
+/**
+ * Computer players.
+ *
+ * The agents work with any game engine that has the interface of Connect4
+ * and Board<W, H, K>. chooseMove() may play and undo moves on the given
+ * game while searching, but leaves it as it was on return. Agents are not
+ * thread safe, create one per game.
+ */
+template <typename Game>
+class Agent
+{
+public:
+    virtual ~Agent() {}
+
+    // Returns the (0 indexed) column to play in.
+    virtual int chooseMove(Game &game) = 0;
+    virtual std::string name() const = 0;
+
+protected:
+    // Distance of a column from the centre, in half columns.
+    static int centreDistance(int column) { return std::abs(2 * column - (Game::Columns - 1)); }
+
+    // Returns the column in which the player to move wins at once, or -1.
+    static int findWinningMove(Game &game)
+    {
+        for (int column = 0; column < Game::Columns; column++) {
+            if (!game.canPlay(column)) continue;
+
+            int gameState = game.play(column);
+            game.undo(column);
+            if (gameState == Game::WON) return column;
+        }
+        return -1;
+    }
+};
+
+// Plays a random legal column.
+template <typename Game>
+class RandomAgent : public Agent<Game>
+{
+public:
+    RandomAgent(unsigned seed) : generator(seed) {    }
+
+    int chooseMove(Game &game)
+    {
+        int moves[Game::Columns];
+        int moveCount = 0;
+
+        for (int column = 0; column < Game::Columns; column++) {
+            if (game.canPlay(column)) moves[moveCount++] = column;
+        }
+
+        std::uniform_int_distribution<int> distribution(0, moveCount - 1);
+        return moves[distribution(generator)];
+    }
+
+    std::string name() const { return "random"; }
+
+private:
+    std::mt19937 generator;
+};
+
+// Wins when it can, blocks when it must and otherwise prefers the centre.
+template <typename Game>
+class HeuristicAgent : public Agent<Game>
+{
+public:
+    HeuristicAgent(unsigned seed) : generator(seed) {    }
+
+    int chooseMove(Game &game)
+    {
+        int winningMove = this->findWinningMove(game);
+        if (winningMove >= 0) return winningMove;
+
+        int bestScore = INT_MIN;
+        int bestMove = -1;
+        std::uniform_int_distribution<int> noise(0, 2);
+
+        for (int column = 0; column < Game::Columns; column++) {
+            if (!game.canPlay(column)) continue;
+
+            // Prefer the centre, with a little noise so games differ.
+            int score = 5 * (Game::Columns - this->centreDistance(column)) + noise(generator);
+
+            // Never hand the opponent a win. This also blocks their threats,
+            // since any other column leaves the threat open.
+            game.play(column);
+            if (this->findWinningMove(game) >= 0) {
+                score -= 1000;
+            }
+            game.undo(column);
+
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = column;
+            }
+        }
+
+        return bestMove;
+    }
+
+    std::string name() const { return "heuristic"; }
+
+private:
+    std::mt19937 generator;
+};
+
+// Negamax search with alpha-beta pruning to a fixed depth. Deep searches
+// search the moves after the first one on the JobSystem.
+template <typename Game>
+class AlphaBetaAgent : public Agent<Game>
+{
+public:
+    AlphaBetaAgent(int depth) : depth(depth)
+    {
+        // Search the centre columns first, this gives far more cutoffs.
+        for (int column = 0; column < Game::Columns; column++) {
+            columnOrder[column] = column;
+        }
+        std::stable_sort(columnOrder, columnOrder + Game::Columns, [](int a, int b) {
+            return Agent<Game>::centreDistance(a) < Agent<Game>::centreDistance(b);
+        });
+    }
+
+    int chooseMove(Game &game)
+    {
+        nodes = 0;
+
+        int moves[Game::Columns];
+        int moveCount = 0;
+        for (int column : columnOrder) {
+            if (game.canPlay(column)) moves[moveCount++] = column;
+        }
+        if (moveCount == 0) return -1;
+
+        int bestMove = moves[0];
+        int alpha = searchMove(game, moves[0], -WinScore - 1, nodes);
+
+        JobSystem &jobs = JobSystem::instance();
+        if (jobs.threadCount() > 1 && depth >= ParallelDepth) {
+            // The other moves only have to beat the first one. Searched at
+            // the same time they are pruned less than one after the other,
+            // but a score above the first is exact, so the move is the same.
+            int scores[Game::Columns];
+            long long moveNodes[Game::Columns] = {};
+            jobs.parallelFor("alphabeta", 1, moveCount, 1, [&](int i) {
+                Game position = game;
+                scores[i] = searchMove(position, moves[i], alpha, moveNodes[i]);
+            });
+            for (int i = 1; i < moveCount; i++) {
+                nodes += moveNodes[i];
+                if (scores[i] > alpha) {
+                    alpha = scores[i];
+                    bestMove = moves[i];
+                }
+            }
+        } else {
+            for (int i = 1; i < moveCount; i++) {
+                int score = searchMove(game, moves[i], alpha, nodes);
+                if (score > alpha) {
+                    alpha = score;
+                    bestMove = moves[i];
+                }
+            }
+        }
+        return bestMove;
+    }
+
+    std::string name() const { return "alphabeta:" + std::to_string(depth); }
+
+    // Number of positions visited by the last call to chooseMove().
+    long long nodeCount() const { return nodes; }
+
+    // Static evaluation of a position from the view of the player to move.
+    // Scores every line of InARow cells that only one player has disks in.
+    static int evaluatePosition(const Game &game)
+    {
+        static const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+        const int length = Game::InARow - 1;
+
+        int score = 0;
+        for (const auto &direction : directions) {
+            for (int row = 0; row < Game::Rows; row++) {
+                for (int column = 0; column < Game::Columns; column++) {
+                    int lastRow = row + length * direction[0];
+                    int lastColumn = column + length * direction[1];
+                    if (lastRow >= Game::Rows || lastColumn < 0 || lastColumn >= Game::Columns) continue;
+
+                    int own = 0, other = 0;
+                    for (int i = 0; i < Game::InARow; i++) {
+                        int owner = game.cellOwner(row + i * direction[0], column + i * direction[1]);
+                        own += owner == Game::CURRENT_PLAYER;
+                        other += owner == Game::OPPONENT;
+                    }
+
+                    // Every extra disk in a line makes it four times as strong.
+                    if (other == 0 && own > 0) score += 1 << (2 * (own - 1));
+                    if (own == 0 && other > 0) score -= 1 << (2 * (other - 1));
+                }
+            }
+        }
+        return score;
+    }
+
+private:
+    static const int WinScore = 1000000;
+    // Shallower searches are over before the jobs would have started.
+    static const int ParallelDepth = 5;
+
+    // Score of playing column, exact if it is more than alpha.
+    int searchMove(Game &game, int column, int alpha, long long &visited) const
+    {
+        int score;
+        if (game.play(column) == Game::WON) {
+            score = WinScore;
+        } else {
+            score = -negamax(game, depth - 1, -WinScore - 1, -alpha, visited);
+        }
+        game.undo(column);
+        return score;
+    }
+
+    int negamax(Game &game, int depth, int alpha, int beta, long long &visited) const
+    {
+        visited++;
+
+        if (game.moveCount() >= Game::Cells) return 0;
+        if (depth <= 0) return evaluatePosition(game);
+
+        for (int column : columnOrder) {
+            if (!game.canPlay(column)) continue;
+
+            int score;
+            if (game.play(column) == Game::WON) {
+                // Prefer quick wins over slow ones.
+                score = WinScore - game.moveCount();
+            } else {
+                score = -negamax(game, depth - 1, -beta, -alpha, visited);
+            }
+            game.undo(column);
+
+            if (score >= beta) return score;
+            if (score > alpha) alpha = score;
+        }
+        return alpha;
+    }
+
+    int depth;
+    int columnOrder[Game::Columns];
+    long long nodes = 0;
+};
+
+// Creates an agent from a specification like "random", "heuristic" or
+// "alphabeta:6". Returns nullptr for an unknown specification.
+template <typename Game>
+std::unique_ptr<Agent<Game>> createAgent(const std::string &spec, unsigned seed)
+{
+    if (spec == "random") {
+        return std::unique_ptr<Agent<Game>>(new RandomAgent<Game>(seed));
+    }
+    if (spec == "heuristic") {
+        return std::unique_ptr<Agent<Game>>(new HeuristicAgent<Game>(seed));
+    }
+
+    const std::string prefix = "alphabeta:";
+    if (spec.compare(0, prefix.size(), prefix) == 0) {
+        // The whole rest has to be a depth of at least 1, up to a board full of moves.
+        const char *digits = spec.c_str() + prefix.size();
+        char *end = nullptr;
+        long depth = std::strtol(digits, &end, 10);
+        if (end != digits && *end == '\0' && depth > 0 && depth <= Game::Cells) {
+            return std::unique_ptr<Agent<Game>>(new AlphaBetaAgent<Game>(int(depth)));
+        }
+    }
+    return nullptr;
+}
+
+#endif // AGENTS_H
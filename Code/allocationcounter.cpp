@@ -0,0 +1,67 @@
+#include "allocationcounter.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef COUNT_ALLOCATIONS
+
+static thread_local quint64 allocations = 0;
+
+static void *allocate(std::size_t size)
+{
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new(std::size_t size)
+{
+    if (void *memory = allocate(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    if (void *memory = allocate(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+
+bool AllocationCounter::isCounting()
+{
+    return true;
+}
+
+quint64 AllocationCounter::count()
+{
+    return allocations;
+}
+
+#else
+
+bool AllocationCounter::isCounting()
+{
+    return false;
+}
+
+quint64 AllocationCounter::count()
+{
+    return 0;
+}
+
+#endif
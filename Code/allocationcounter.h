@@ -0,0 +1,21 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The AllocationCounter class
+ *
+ * Counts the allocations made with the global operator new, per thread.
+ * Only builds with COUNT_ALLOCATIONS replace operator new, scene.pri
+ * defines it in debug builds. In other builds the count stays 0.
+ */
+class AllocationCounter
+{
+public:
+    static bool isCounting();
+    // Allocations made by the calling thread so far.
+    static quint64 count();
+};
+
+#endif // ALLOCATIONCOUNTER_H
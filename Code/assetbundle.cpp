@@ -0,0 +1,165 @@
+#include "assetbundle.h"
+#include "eventlog.h"
+#include "model.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QMutex>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+// Where scene.pri finds models/, textures/ and shaders/.
+#ifndef ASSET_DIRECTORY
+#define ASSET_DIRECTORY "."
+#endif
+
+namespace {
+
+QMutex sharedMutex;
+AssetBundle *sharedBundle = nullptr;
+
+}
+
+bool AssetBundle::open(const QString &fileName)
+{
+    mapped.setFileName(fileName);
+    if (!mapped.open(QIODevice::ReadOnly)) return false;
+
+    qint64 size = mapped.size();
+    const uchar *map = size >= qint64(sizeof(Header)) ? mapped.map(0, size) : nullptr;
+    if (!map) {
+        mapped.close();
+        return false;
+    }
+
+    // Everything the lookups rely on is checked once here.
+    const Header *header = reinterpret_cast<const Header *>(map);
+    const Entry *index = reinterpret_cast<const Entry *>(map + sizeof(Header));
+    bool valid = header->magic == Magic && header->version == Version &&
+                 quint64(size) >= sizeof(Header) + quint64(header->entryCount) * sizeof(Entry);
+    for (quint32 i = 0; valid && i < header->entryCount; i++) {
+        const Entry &entry = index[i];
+        valid = std::memchr(entry.name, 0, NameSize) != nullptr &&
+                (i == 0 || std::strcmp(index[i - 1].name, entry.name) < 0) &&
+                entry.offset <= quint64(size) && entry.size <= quint64(size) - entry.offset;
+        if (entry.type == IMAGE) {
+            valid = valid && entry.size == quint64(entry.width) * entry.height * 4;
+        } else if (entry.type == MESH) {
+            valid = valid && entry.size % (8 * sizeof(float)) == 0;
+        }
+    }
+    if (!valid) {
+        EventLog::warning("%s is not an asset bundle of version %u.", qPrintable(fileName), Version);
+        mapped.unmap(const_cast<uchar *>(map));
+        mapped.close();
+        return false;
+    }
+
+    data = map;
+    entries = index;
+    entryCount = header->entryCount;
+    source = fileName;
+    return true;
+}
+
+void AssetBundle::openDirectory(const QString &directory)
+{
+    source = directory;
+}
+
+const AssetBundle::Entry *AssetBundle::find(const QString &name) const
+{
+    QByteArray key = name.toUtf8();
+    const Entry *entry = std::lower_bound(begin(), end(), key, [](const Entry &entry, const QByteArray &key) {
+        return std::strcmp(entry.name, key.constData()) < 0;
+    });
+    return entry != end() && key == entry->name ? entry : nullptr;
+}
+
+QByteArray AssetBundle::bytes(const Entry &entry) const
+{
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(data + entry.offset), int(entry.size));
+}
+
+bool AssetBundle::contains(const QString &name) const
+{
+    return isMapped() ? find(name) != nullptr : QFile::exists(source + "/" + name);
+}
+
+QByteArray AssetBundle::file(const QString &name) const
+{
+    if (!isMapped()) {
+        QFile file(source + "/" + name);
+        if (!file.open(QIODevice::ReadOnly)) {
+            EventLog::warning("Could not read the asset %s from %s.", qPrintable(name), qPrintable(source));
+        }
+        return file.readAll();
+    }
+
+    const Entry *entry = find(name);
+    if (!entry || entry->type != FILE) {
+        EventLog::warning("%s has no file %s.", qPrintable(source), qPrintable(name));
+        return QByteArray();
+    }
+    return bytes(*entry);
+}
+
+QImage AssetBundle::image(const QString &name) const
+{
+    const Entry *entry = isMapped() ? find(name) : nullptr;
+    if (entry && entry->type == IMAGE) {
+        return QImage(data + entry->offset, int(entry->width), int(entry->height),
+                      int(entry->width) * 4, QImage::Format_RGBA8888);
+    }
+
+    // (0, 0) is the bottom left in OpenGL.
+    return QImage::fromData(file(name)).convertToFormat(QImage::Format_RGBA8888).mirrored();
+}
+
+QVector<float> AssetBundle::mesh(const QString &name) const
+{
+    const Entry *entry = isMapped() ? find(name) : nullptr;
+    if (entry && entry->type == MESH) {
+        QVector<float> vertices(int(entry->size / sizeof(float)));
+        std::memcpy(vertices.data(), data + entry->offset, entry->size);
+        return vertices;
+    }
+
+    QByteArray source = file(name);
+    QBuffer buffer(&source);
+    buffer.open(QIODevice::ReadOnly);
+    Model model(buffer);
+    model.unitize();
+    return model.getVNTInterleaved();
+}
+
+const AssetBundle &AssetBundle::shared()
+{
+    QMutexLocker locker(&sharedMutex);
+    if (!sharedBundle) {
+        sharedBundle = new AssetBundle;
+        QString fileName = QCoreApplication::applicationDirPath() + "/assets.bundle";
+        if (!QFile::exists(fileName) || !sharedBundle->open(fileName)) {
+            // Only works on the machine that built the program, from its source tree.
+            EventLog::warning("There is no asset bundle at %s, reading the loose files in %s instead. "
+                              "Pack one with connect4_pack, or pass --assets.",
+                              qPrintable(fileName), ASSET_DIRECTORY);
+            sharedBundle->openDirectory(ASSET_DIRECTORY);
+        }
+        EventLog::info("Assets from %s", qPrintable(sharedBundle->location()));
+    }
+    return *sharedBundle;
+}
+
+bool AssetBundle::setShared(const QString &fileName)
+{
+    std::unique_ptr<AssetBundle> bundle(new AssetBundle);
+    if (!bundle->open(fileName)) return false;
+
+    QMutexLocker locker(&sharedMutex);
+    delete sharedBundle;
+    sharedBundle = bundle.release();
+    EventLog::info("Assets from %s", qPrintable(sharedBundle->location()));
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef ASSETBUNDLE_H
+#define ASSETBUNDLE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The AssetBundle class
+ *
+ * The models, textures and shaders, read from one file that tools/pack
+ * builds from models/, textures/ and shaders/. The file is memory mapped,
+ * so an asset is only read from the disk when it is used, and processes
+ * that run at the same time share the pages.
+ *
+ * The file starts with a Header and an index of Entries sorted by name,
+ * and every asset starts on a page of its own. An asset is either the
+ * file as it is, or decoded by the packer: an image as RGBA8888 rows from
+ * the bottom up, as OpenGL wants them, and a model as the unitized
+ * Model::getVNTInterleaved. The bundle is written in the byte order of
+ * the host that packs it.
+ *
+ * Assets are named by their path under the source directory, e.g.
+ * textures/wood.png. A bundle made from a directory reads its files
+ * instead, for a build without a bundle.
+ */
+class AssetBundle
+{
+public:
+    static const quint32 Magic = 0x42344e43; // "CN4B"
+    static const quint32 Version = 1;
+    static const int Alignment = 4096;
+    static const int NameSize = 48;
+
+    enum EntryType : quint32
+    {
+        FILE = 0, IMAGE, MESH
+    };
+
+    struct Header
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 entryCount;
+        quint32 reserved;
+    };
+
+    struct Entry
+    {
+        char name[NameSize]; // 0 terminated
+        quint32 type;
+        quint32 width, height; // Of an IMAGE
+        quint32 reserved;
+        quint64 offset;
+        quint64 size;
+    };
+
+    AssetBundle() = default;
+    AssetBundle(const AssetBundle &) = delete;
+    AssetBundle &operator=(const AssetBundle &) = delete;
+
+    // Maps a bundle, false if it is not one.
+    bool open(const QString &fileName);
+    // Reads the assets from the files in directory.
+    void openDirectory(const QString &directory);
+
+    bool isMapped() const { return data != nullptr; }
+    // The bundle or the directory.
+    QString location() const { return source; }
+
+    bool contains(const QString &name) const;
+    // The index, empty for a directory.
+    const Entry *begin() const { return entries; }
+    const Entry *end() const { return entries + entryCount; }
+
+    // The contents of a FILE. Points into the mapping, which stays as long
+    // as the bundle.
+    QByteArray file(const QString &name) const;
+    // RGBA8888, rows from the bottom up. A decoded image points into the
+    // mapping as well.
+    QImage image(const QString &name) const;
+    // The unitized model, 8 floats per vertex like Model::getVNTInterleaved.
+    QVector<float> mesh(const QString &name) const;
+
+    // The bundle of the program. Unless setShared opened another one, the
+    // first call opens assets.bundle next to the executable, or the source
+    // directory when there is none. It is never closed.
+    static const AssetBundle &shared();
+    // Call before anything is loaded.
+    static bool setShared(const QString &fileName);
+
+private:
+    const Entry *find(const QString &name) const;
+    QByteArray bytes(const Entry &entry) const;
+
+    QFile mapped;
+    const uchar *data = nullptr;
+    const Entry *entries = nullptr;
+    quint32 entryCount = 0;
+    QString source;
+};
+
+#endif // ASSETBUNDLE_H
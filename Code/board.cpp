@@ -0,0 +1,7 @@
+#include "board.h"
+
+// Compile the supported variants once, instead of in every file that uses them.
+template class Board<7, 6, 4>;
+template class Board<8, 7, 4>;
+template class Board<9, 7, 4>;
+template class Board<9, 6, 5>;
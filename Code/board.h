@@ -0,0 +1,179 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief The Board class
+ *
+ * The rules of Connect-K on a W x H board, kept in two bit masks: one with
+ * the disks of the player to move and one with all disks. Every column
+ * takes H + 1 bits, the empty bit on top keeps lines from wrapping into the
+ * next column. For the standard 7 x 6 board the bits are numbered
+ *
+ *   6 13 20 27 34 41 48
+ *   5 12 19 26 33 40 47
+ *   4 11 18 25 32 39 46
+ *   3 10 17 24 31 38 45
+ *   2  9 16 23 30 37 44
+ *   1  8 15 22 29 36 43
+ *   0  7 14 21 28 35 42
+ *
+ * All masks and shifts are computed at compile time, so every variant runs
+ * without branching on its dimensions. Boards that need more than 64 bits
+ * use a 128 bit integer. Shares the part of the interface of Connect4 that
+ * the agents and the perft tool use: the dimensions, clear(), canPlay(),
+ * play(), undo(), height(), moveCount(), cellOwner() and the GameState and
+ * Owner values. It knows no colours, the game state comes from state() and
+ * isGameOver() instead of isGameWon() and winner().
+ */
+template <int W, int H, int K>
+class Board
+{
+public:
+    static const int Columns = W;
+    static const int Rows = H;
+    static const int InARow = K;
+    static const int Cells = W * H;
+
+    // A line only has to fit one way, e.g. 5 in a row on a board 4 high is won across.
+    static_assert(K >= 2 && (K <= W || K <= H), "K in a row has to fit on the board");
+    static_assert(W * (H + 1) <= 128, "the board has to fit in 128 bits");
+
+    typedef typename std::conditional<W * (H + 1) <= 64, uint64_t, unsigned __int128>::type Mask;
+
+    enum GameState
+    {
+        UNFINISHED = 0, WON, DRAW
+    };
+
+    enum Owner
+    {
+        EMPTY = 0, CURRENT_PLAYER, OPPONENT
+    };
+
+    Board() { clear(); }
+
+    void clear()
+    {
+        current = 0;
+        mask = 0;
+        diskCount = 0;
+        gameState = UNFINISHED;
+    }
+
+    bool canPlay(int column) const
+    {
+        return gameState == UNFINISHED && column >= 0 && column < W
+                && (mask & topMask(column)) == 0;
+    }
+
+    // Drops a disk for the player to move and switches turns.
+    int play(int column)
+    {
+        current ^= mask;
+        mask |= mask + bottomMask(column);
+        diskCount += 1;
+
+        // current now holds the disks of the opponent of the player that moved.
+        if (isWin(current ^ mask)) {
+            gameState = WON;
+        } else if (diskCount >= Cells) {
+            gameState = DRAW;
+        }
+        return gameState;
+    }
+
+    // Takes back the last disk played in column.
+    void undo(int column)
+    {
+        // The next free cell of the column, shifted down onto the top disk.
+        Mask top = ((mask + bottomMask(column)) & columnMask(column)) >> 1;
+        mask ^= top;
+        current ^= mask;
+        diskCount -= 1;
+        gameState = UNFINISHED;
+    }
+
+    int height(int column) const { return popcount(mask & columnMask(column)); }
+
+    int moveCount() const { return diskCount; }
+    int state() const { return gameState; }
+    bool isGameOver() const { return gameState != UNFINISHED; }
+
+    int cellOwner(int row, int column) const
+    {
+        Mask cell = Mask(1) << (column * (H + 1) + row);
+        if ((mask & cell) == 0) {
+            return EMPTY;
+        }
+        return (current & cell) ? CURRENT_PLAYER : OPPONENT;
+    }
+
+private:
+    static constexpr Mask bottomMask(int column) { return Mask(1) << (column * (H + 1)); }
+    static constexpr Mask topMask(int column) { return Mask(1) << (column * (H + 1) + H - 1); }
+    static constexpr Mask columnMask(int column) { return ((Mask(1) << (H + 1)) - 1) << (column * (H + 1)); }
+
+    static int popcount(Mask bits)
+    {
+        int count = __builtin_popcountll(uint64_t(bits));
+        // Two shifts, one of 64 would be undefined for a 64 bit Mask.
+        if (sizeof(Mask) > sizeof(uint64_t)) count += __builtin_popcountll(uint64_t(bits >> 32 >> 32));
+        return count;
+    }
+
+    // disks >> shift, or none if no line fits in a shift that long. Lines
+    // that do not fit on the board, like across a narrow board, can shift
+    // past the width of Mask.
+    static Mask shifted(Mask disks, int shift)
+    {
+        return shift < int(8 * sizeof(Mask)) ? disks >> shift : Mask(0);
+    }
+
+    // Shifts from a cell to its neighbour: vertical, horizontal and both diagonals.
+    static constexpr int VerticalShift = 1;
+    static constexpr int HorizontalShift = H + 1;
+    static constexpr int DiagonalShift = H;
+    static constexpr int AntiDiagonalShift = H + 2;
+
+    // Marks every disk that starts a line of K disks along shift.
+    template <int Shift>
+    static Mask lines(Mask disks)
+    {
+        // Doubles the covered length every step: runs of 2, 4, ... disks.
+        Mask runs = disks;
+        int length = 1;
+        while (2 * length <= K) {
+            runs &= shifted(runs, length * Shift);
+            length *= 2;
+        }
+        if (length < K) {
+            runs &= shifted(runs, (K - length) * Shift);
+        }
+        return runs;
+    }
+
+    static bool isWin(Mask disks)
+    {
+        return lines<VerticalShift>(disks) || lines<HorizontalShift>(disks)
+                || lines<DiagonalShift>(disks) || lines<AntiDiagonalShift>(disks);
+    }
+
+    Mask current;
+    Mask mask;
+    int diskCount;
+    int gameState;
+};
+
+// The variants the game and the tools are built for, defined in board.cpp.
+extern template class Board<7, 6, 4>;
+extern template class Board<8, 7, 4>;
+extern template class Board<9, 7, 4>;
+extern template class Board<9, 6, 5>;
+
+// The standard game.
+typedef Board<7, 6, 4> BitBoard;
+
+#endif // BOARD_H
@@ -0,0 +1,45 @@
+#include "boardwall.h"
+
+// Seconds between two moves on a board, and before a finished game starts over.
+static const double ShortestMove = 0.4;
+static const double LongestMove = 1.2;
+static const double RestartDelay = 3;
+
+BoardWall::BoardWall(int boardCount, unsigned seed)
+    : generator(seed)
+{
+    for (int i = 0; i < boardCount; i++) {
+        std::unique_ptr<WallBoard> board(new WallBoard);
+        board->player = createAgent<GameBoard>("heuristic", seed + i);
+        board->game.clear();
+        // Not every board moves at the same time.
+        board->untilMove = moveInterval();
+        boards.push_back(std::move(board));
+    }
+}
+
+double BoardWall::moveInterval()
+{
+    return std::uniform_real_distribution<double>(ShortestMove, LongestMove)(generator);
+}
+
+void BoardWall::advance(double seconds)
+{
+    for (std::unique_ptr<WallBoard> &board : boards) {
+        board->game.advance(seconds);
+
+        board->untilMove -= seconds;
+        if (board->untilMove > 0) continue;
+
+        if (board->game.board().isGameOver()) {
+            board->game.clear();
+            board->untilMove = moveInterval();
+            continue;
+        }
+
+        // The player searches on a copy, the game is only changed by dropping the disk.
+        GameBoard position = board->game.board();
+        board->game.dropDisk(board->player->chooseMove(position) + 1);
+        board->untilMove = board->game.board().isGameOver() ? RestartDelay : moveInterval();
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef BOARDWALL_H
+#define BOARDWALL_H
+
+#include "agents.h"
+#include "game.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * @brief The BoardWall class
+ *
+ * Many games at once, for the grid view and its benchmark. Every board is
+ * played by a computer player that moves at its own pace, and starts over
+ * a few seconds after its game ended. Seeded, so a benchmark plays the
+ * same games every run.
+ */
+class BoardWall
+{
+public:
+    explicit BoardWall(int boardCount, unsigned seed = 1);
+
+    // Plays the moves that are due and animates the disks.
+    void advance(double seconds);
+
+    int boardCount() const { return static_cast<int>(boards.size()); }
+    const SceneState &scene(int board) const { return boards[board]->game.scene(); }
+
+private:
+    struct WallBoard
+    {
+        Game game;
+        std::unique_ptr<Agent<GameBoard>> player;
+        double untilMove = 0;
+    };
+
+    double moveInterval();
+
+    std::vector<std::unique_ptr<WallBoard>> boards;
+    std::mt19937 generator;
+};
+
+#endif // BOARDWALL_H
@@ -0,0 +1,109 @@
+#include "connect4.h"
+
+Connect4::Connect4()
+{
+    clear();
+}
+
+void Connect4::clear()
+{
+    diskCount = 0;
+
+    for(int i = 0; i < Columns; i++){
+        columnCount[i] = 0;
+    }
+
+    for(int i = 0; i < Rows; i++){
+        for(int j = 0; j < Columns; j++){
+            board[i][j] = '0';
+        }
+    }
+
+    gameWinner = '0';
+}
+
+bool Connect4::canPlay(int column) const
+{
+    return gameWinner == '0' && column >= 0 && column < Columns && columnCount[column] < Rows;
+}
+
+int Connect4::play(int column)
+{
+    int row = columnCount[column];
+    board[row][column] = currentPlayer();
+
+    // Increment disk count now, so isGameWon() can also check whether a draw has occurred
+    diskCount += 1;
+
+    int gameState = isGameWon(row, column);
+
+    switch (gameState){
+        case WON:
+            gameWinner = currentPlayer();
+            break;
+        case DRAW:
+            gameWinner = 'd';
+            break;
+    }
+
+    // Increment column count, so the next piece in this column knows its location
+    columnCount[column] += 1;
+    // Turn completed. Switch turn to other player.
+    yellowPlayer = !yellowPlayer;
+
+    return gameState;
+}
+
+void Connect4::undo(int column)
+{
+    columnCount[column] -= 1;
+    board[columnCount[column]][column] = '0';
+    diskCount -= 1;
+    yellowPlayer = !yellowPlayer;
+    gameWinner = '0';
+}
+
+int Connect4::cellOwner(int row, int column) const
+{
+    if (board[row][column] == '0') {
+        return EMPTY;
+    }
+    return board[row][column] == currentPlayer() ? CURRENT_PLAYER : OPPONENT;
+}
+
+// Checks if game is won. Returns 0 for an unfinished game, 1 for a win and 2 for a draw.
+// The given parameters are the x and y coordinate of the placed piece.
+int Connect4::isGameWon(int x, int y) const
+{
+    char currentPlayer = board[x][y]; // The player who placed the most recent piece
+    int i, j;
+
+    // Checks vertically
+    int verticalPieces = 1;
+    for(i = x - 1; i >= 0 && board[i][y] == currentPlayer; verticalPieces++, i--);
+    for(i = x + 1; i <= 5 && board[i][y] == currentPlayer; verticalPieces++, i++);  // Technically not required because there can be no pieces above the placed one
+    if (verticalPieces >= 4) return WON;
+
+    // Checks horizontally
+    int horizontalPieces = 1;
+    for(j = y - 1; j >= 0 && board[x][j] == currentPlayer; horizontalPieces++, j--);
+    for(j = y + 1; j <= 6 && board[x][j] == currentPlayer; horizontalPieces++, j++);
+    if (horizontalPieces >= 4) return WON;
+
+    // Checks bottom left to top right diagonal
+    int diagonalPieces1 = 1;
+    for (i = x - 1, j = y - 1; i >= 0 && j >= 0 && board[i][j] == currentPlayer; diagonalPieces1++, i--, j--);
+    for (i = x + 1, j = y + 1; i <= 5 && j <= 6 && board[i][j] == currentPlayer; diagonalPieces1++, i++, j++);
+    if (diagonalPieces1 >= 4) return WON;
+
+    // Checks top left to bottom right diagonal
+    int diagonalPieces2 = 1;
+    for (i = x - 1, j = y + 1; i >= 0 && j <= 6 && board[i][j] == currentPlayer; diagonalPieces2++, i--, j++);
+    for (i = x + 1, j = y - 1; i <= 5 && j >= 0 && board[i][j] == currentPlayer; diagonalPieces2++, i++, j--);
+    if (diagonalPieces2 >= 4) return WON;
+
+    if(diskCount >= Cells){
+        return DRAW;
+    }
+    return UNFINISHED;
+}
@@ -0,0 +1,72 @@
+#ifndef CONNECT4_H
+#define CONNECT4_H
+
+/**
+ * @brief The Connect4 class
+ *
+ * The reference implementation of the rules on the standard board.
+ * The board is stored as a char array: '0' for an empty cell,
+ * 'y' for a yellow disk and 'r' for a red disk.
+ *
+ * The game itself plays on the faster Board<W, H, K> (board.h), the
+ * perft tool checks the two against each other.
+ * Columns are indexed from 0.
+ */
+class Connect4
+{
+public:
+    static const int Columns = 7;
+    static const int Rows = 6;
+    static const int InARow = 4;
+    static const int Cells = Columns * Rows;
+
+    // Return values of play() and isGameWon()
+    enum GameState
+    {
+        UNFINISHED = 0, WON, DRAW
+    };
+
+    // Return values of cellOwner()
+    enum Owner
+    {
+        EMPTY = 0, CURRENT_PLAYER, OPPONENT
+    };
+
+    Connect4();
+
+    // Empties the board. The player to move is kept, so resetting
+    // can be used to let the other colour make the first move.
+    void clear();
+
+    bool canPlay(int column) const;
+
+    // Drops a disk for the player to move and switches turns.
+    // Returns the GameState after the move.
+    int play(int column);
+
+    // Takes back the last disk played in column.
+    void undo(int column);
+
+    int isGameWon(int x, int y) const;
+
+    int height(int column) const { return columnCount[column]; }
+    int moveCount() const { return diskCount; }
+    char cell(int row, int column) const { return board[row][column]; }
+    int cellOwner(int row, int column) const;
+
+    bool isYellowPlayer() const { return yellowPlayer; }
+    char currentPlayer() const { return yellowPlayer ? 'y' : 'r'; }
+
+    // '0' while playing, 'y' or 'r' for the winner and 'd' for a draw.
+    char winner() const { return gameWinner; }
+    bool isGameOver() const { return gameWinner != '0'; }
+
+private:
+    char board[Rows][Columns];
+    int columnCount[Columns];
+    int diskCount = 0;
+    bool yellowPlayer = true;
+    char gameWinner = '0';
+};
+
+#endif // CONNECT4_H
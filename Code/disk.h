@@ -5,19 +5,34 @@
 
 struct Disk
 {
-    int keyFrameNumber;
     float x, y;
     bool yellowDisk;
 
+    // Height above (x, y) in the last two steps of the simulation, the
+    // renderer interpolates between them. Speed is downwards.
+    float height = 0, previousHeight = 0;
+    float speed = 0;
+    bool landed = true;
+
     Disk() = default;
 
-    Disk(int keyFrameNumber, float x, float y, bool yellowDisk)
+    Disk(float x, float y, bool yellowDisk)
         :
-          keyFrameNumber(keyFrameNumber),
           x(x),
           y(y),
           yellowDisk(yellowDisk)
     {    }
+
+    // Where the disk is and will stay, the height of a falling disk does not matter.
+    bool operator==(const Disk &other) const
+    {
+        return x == other.x && y == other.y && yellowDisk == other.yellowDisk && landed == other.landed;
+    }
+
+    float heightAt(float interpolation) const
+    {
+        return previousHeight + (height - previousHeight) * interpolation;
+    }
 };
 
 #endif // DISK_H
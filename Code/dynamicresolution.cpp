@@ -0,0 +1,103 @@
+#include "dynamicresolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The scene is drawn at no less than half the width and height of the window.
+static const float MinimumScale = 0.5f;
+// Weight of the newest frame in the smoothed GPU time.
+static const float Smoothing = 0.2f;
+// A scale that is lowered aims this far under the budget.
+static const float Headroom = 0.9f;
+// The scale goes up a step after RaiseAfter frames under this part of the budget.
+static const float RaiseBelow = 0.7f;
+static const int RaiseAfter = 30;
+static const float RaiseStep = 0.05f;
+// Scales are rounded to this step, small changes are not worth redrawing the static layer.
+static const float Granularity = 1 / 32.f;
+
+void DynamicResolution::initialize()
+{
+    initializeOpenGLFunctions();
+
+    glGenQueries(FramesInFlight * 2, &queries[0][0]);
+    std::fill(issued, issued + FramesInFlight, false);
+    initialized = true;
+}
+
+void DynamicResolution::destroy()
+{
+    if (!initialized) return;
+
+    glDeleteQueries(FramesInFlight * 2, &queries[0][0]);
+    initialized = false;
+}
+
+bool DynamicResolution::beginFrame()
+{
+    if (!initialized) return false;
+
+    float previousScale = currentScale;
+    int slot = frameCount % FramesInFlight;
+
+    if (issued[slot]) {
+        issued[slot] = false;
+
+        // Results that are still not available are dropped.
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+            adapt((end - start) / 1e6f);
+        }
+    }
+
+    glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+    return currentScale != previousScale;
+}
+
+void DynamicResolution::endFrame()
+{
+    if (!initialized) return;
+
+    int slot = frameCount % FramesInFlight;
+    glQueryCounter(queries[slot][1], GL_TIMESTAMP);
+    issued[slot] = true;
+    frameCount++;
+}
+
+void DynamicResolution::adapt(float milliseconds)
+{
+    // Frames that were in flight when the scale changed were drawn at the old scale.
+    if (cooldown > 0) {
+        cooldown--;
+        return;
+    }
+
+    smoothedTime = smoothedTime > 0 ? smoothedTime + Smoothing * (milliseconds - smoothedTime) : milliseconds;
+
+    if (smoothedTime > budget) {
+        // The GPU time is about proportional to the number of pixels.
+        setScale(currentScale * std::sqrt(budget * Headroom / smoothedTime));
+    } else if (smoothedTime < budget * RaiseBelow && currentScale < 1) {
+        if (++framesUnder >= RaiseAfter) {
+            setScale(currentScale + RaiseStep);
+        }
+    } else {
+        framesUnder = 0;
+    }
+}
+
+void DynamicResolution::setScale(float scale)
+{
+    scale = std::round(scale / Granularity) * Granularity;
+    scale = std::min(1.f, std::max(MinimumScale, scale));
+    framesUnder = 0;
+    if (scale == currentScale) return;
+
+    currentScale = scale;
+    cooldown = FramesInFlight;
+    smoothedTime = 0;
+}
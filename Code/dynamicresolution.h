@@ -0,0 +1,60 @@
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include <QOpenGLFunctions_3_3_Core>
+
+/**
+ * @brief The DynamicResolution class
+ *
+ * Chooses the fraction of the window size the scene is drawn at, so that
+ * the GPU time of a frame stays under a budget. The GPU time is measured
+ * with timestamp queries, which do not get in the way of the
+ * GL_TIME_ELAPSED queries of the FrameProfiler. The results are read
+ * FramesInFlight frames later, so measuring never waits for the GPU.
+ *
+ * Frames slower than the budget lower the scale at once, in proportion to
+ * how much too slow they are. The scale goes up again only in small steps,
+ * after a run of frames well under the budget. No change is made until a
+ * change has been measured, so the scale does not oscillate.
+ */
+class DynamicResolution : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    static const int FramesInFlight = 3;
+
+    // Creates the queries, needs a current context.
+    void initialize();
+    void destroy();
+
+    void setBudget(float milliseconds) { budget = milliseconds; }
+    float budgetMilliseconds() const { return budget; }
+
+    // Reads the GPU time of an earlier frame, adapts the scale to it and
+    // starts timing this frame. Returns true if the scale changed.
+    bool beginFrame();
+    void endFrame();
+
+    float scale() const { return currentScale; }
+    // GPU time of the last frames, smoothed, in milliseconds.
+    float gpuTime() const { return smoothedTime; }
+
+private:
+    void adapt(float milliseconds);
+    void setScale(float scale);
+
+    bool initialized = false;
+    float budget = 14.f;
+    float currentScale = 1.f;
+    float smoothedTime = 0;
+    // Frames in a row well under the budget.
+    int framesUnder = 0;
+    // Frames to wait until the last change shows in the measurements.
+    int cooldown = 0;
+
+    qint64 frameCount = 0;
+    // A start and an end timestamp per frame in flight.
+    GLuint queries[FramesInFlight][2];
+    bool issued[FramesInFlight];
+};
+
+#endif // DYNAMICRESOLUTION_H
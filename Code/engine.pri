@@ -0,0 +1,15 @@
+# Game rules and computer players, shared by the game and the
+# command line tools in tools/. Does not depend on Qt.
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/connect4.cpp \
+    $$PWD/board.cpp \
+    $$PWD/gamerecord.cpp \
+    $$PWD/jobsystem.cpp
+
+HEADERS += $$PWD/connect4.h \
+    $$PWD/board.h \
+    $$PWD/gamerecord.h \
+    $$PWD/jobsystem.h \
+    $$PWD/agents.h
@@ -0,0 +1,261 @@
+#include "eventlog.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char *const LevelNames[] = {"warning", "info", "debug", "trace"};
+
+// A bounded queue for many producers and one consumer. Every slot has a
+// sequence number: a producer may fill the slot at position p when it is
+// p, and makes it p + 1 when the message is complete. The writer makes it
+// p + Capacity when it has written it, which frees it for the next round.
+struct Slot
+{
+    std::atomic<quint64> sequence;
+    qint64 time;
+    EventLog::Level level;
+    char text[EventLog::MessageSize];
+};
+
+class Ring
+{
+public:
+    Ring()
+    {
+        for (int i = 0; i < EventLog::Capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        clock.start();
+    }
+
+    void push(EventLog::Level level, const char *format, va_list arguments)
+    {
+        quint64 position = head.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots[position % EventLog::Capacity];
+            qint64 difference = static_cast<qint64>(slot->sequence.load(std::memory_order_acquire) - position);
+            if (difference == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                // The writer has not written this slot of the last round yet.
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->time = clock.nsecsElapsed();
+        slot->level = level;
+        std::vsnprintf(slot->text, sizeof(slot->text), format, arguments);
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // Only the writer pops. Returns false if the next message is not complete yet.
+    bool pop(Slot &message)
+    {
+        Slot &slot = slots[tail % EventLog::Capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+
+        message.time = slot.time;
+        message.level = slot.level;
+        std::memcpy(message.text, slot.text, sizeof(message.text));
+        slot.sequence.store(tail + EventLog::Capacity, std::memory_order_release);
+        tail++;
+        return true;
+    }
+
+    std::atomic<int> level{EventLog::INFO};
+    std::atomic<quint64> dropped{0};
+
+private:
+    Slot slots[EventLog::Capacity];
+    std::atomic<quint64> head{0};
+    quint64 tail = 0;
+    QElapsedTimer clock;
+};
+
+Ring &ring()
+{
+    static Ring instance;
+    return instance;
+}
+
+// Drains the ring while it is running, and once more when it stops.
+class Writer : public QThread
+{
+public:
+    bool open(const QString &fileName)
+    {
+        if (fileName.isEmpty()) return file.open(stderr, QIODevice::WriteOnly);
+        file.setFileName(fileName);
+        return file.open(QIODevice::WriteOnly | QIODevice::Append);
+    }
+
+    void stop() { running = false; }
+
+    std::atomic<quint64> totalDropped{0};
+
+protected:
+    void run()
+    {
+        while (running) {
+            if (!drain()) msleep(IdleMilliseconds);
+        }
+        drain();
+        file.close();
+    }
+
+private:
+    static const int IdleMilliseconds = 5;
+
+    // Returns false if there was nothing to write.
+    bool drain()
+    {
+        Slot message;
+        int count = 0;
+        while (ring().pop(message)) {
+            char line[EventLog::MessageSize + 32];
+            int length = std::snprintf(line, sizeof(line), "[%10.3f %-7s] %s\n",
+                                       message.time / 1e6, LevelNames[message.level], message.text);
+            file.write(line, qMin(length, static_cast<int>(sizeof(line)) - 1));
+            count++;
+        }
+
+        quint64 dropped = ring().dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            char line[64];
+            int length = std::snprintf(line, sizeof(line), "[%10s %-7s] %llu messages dropped\n",
+                                       "", "warning", static_cast<unsigned long long>(dropped));
+            file.write(line, length);
+            totalDropped += dropped;
+        }
+
+        if (count > 0 || dropped > 0) file.flush();
+        return count > 0;
+    }
+
+    QFile file;
+    std::atomic<bool> running{true};
+};
+
+Writer *writer = nullptr;
+
+} // namespace
+
+void EventLog::setLevel(Level level)
+{
+    ring().level.store(level, std::memory_order_relaxed);
+}
+
+EventLog::Level EventLog::level()
+{
+    return static_cast<Level>(ring().level.load(std::memory_order_relaxed));
+}
+
+bool EventLog::parseLevel(const QString &name, Level &level)
+{
+    for (int i = WARNING; i <= TRACE; i++) {
+        if (name == QLatin1String(LevelNames[i])) {
+            level = static_cast<Level>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EventLog::start(const QString &fileName)
+{
+    if (writer) return true;
+
+    writer = new Writer;
+    if (!writer->open(fileName)) {
+        delete writer;
+        writer = nullptr;
+        return false;
+    }
+    writer->start(QThread::LowPriority);
+    // Whichever way main returns.
+    if (QCoreApplication::instance()) qAddPostRoutine(&EventLog::stop);
+    return true;
+}
+
+void EventLog::stop()
+{
+    if (!writer) return;
+
+    writer->stop();
+    writer->wait();
+    delete writer;
+    writer = nullptr;
+}
+
+quint64 EventLog::droppedMessages()
+{
+    return (writer ? writer->totalDropped.load() : 0) + ring().dropped.load(std::memory_order_relaxed);
+}
+
+void EventLog::write(Level level, const char *format, va_list arguments)
+{
+    if (!isEnabled(level)) return;
+    ring().push(level, format, arguments);
+}
+
+void EventLog::warning(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    write(WARNING, format, arguments);
+    va_end(arguments);
+}
+
+void EventLog::info(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    write(INFO, format, arguments);
+    va_end(arguments);
+}
+
+void EventLog::debug(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    write(DEBUG, format, arguments);
+    va_end(arguments);
+}
+
+void EventLog::trace(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    write(TRACE, format, arguments);
+    va_end(arguments);
+}
+
+QOpenGLDebugLogger::LoggingMode EventLog::openGLLoggingMode()
+{
+    return isEnabled(TRACE) ? QOpenGLDebugLogger::SynchronousLogging : QOpenGLDebugLogger::AsynchronousLogging;
+}
+
+void EventLog::logOpenGLMessage(const QOpenGLDebugMessage &message)
+{
+    Level level = message.severity() == QOpenGLDebugMessage::HighSeverity ? WARNING : DEBUG;
+    if (!isEnabled(level)) return;
+
+    // Asynchronous messages may come from a thread of the driver.
+    QByteArray text = message.message().toUtf8();
+    if (level == WARNING) {
+        warning("OpenGL: %s", text.constData());
+    } else {
+        debug("OpenGL: %s", text.constData());
+    }
+}
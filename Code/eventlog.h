@@ -0,0 +1,66 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <QOpenGLDebugLogger>
+#include <QOpenGLDebugMessage>
+#include <QString>
+#include <cstdarg>
+
+/**
+ * @brief The EventLog class
+ *
+ * Log of the game and render events that never waits. A message is
+ * formatted straight into a slot of a ring buffer, which a producer
+ * claims with an atomic counter, and a background thread writes the
+ * slots out. Any thread may log; when the ring is full the message is
+ * dropped and counted instead.
+ *
+ * The level is the diagnostics level of the whole program: messages above
+ * it are not even formatted, and from DEBUG on OpenGL runs with a debug
+ * context and its messages are logged as well. Only TRACE logs them
+ * synchronously, which makes the driver report every message at the
+ * call that caused it but serializes it.
+ */
+class EventLog
+{
+public:
+    enum Level
+    {
+        WARNING = 0, INFO, DEBUG, TRACE
+    };
+
+    static const int Capacity = 1024;
+    // Longer messages are cut off.
+    static const int MessageSize = 120;
+
+    static void setLevel(Level level);
+    static Level level();
+    static bool isEnabled(Level level) { return level <= EventLog::level(); }
+    // warning, info, debug or trace.
+    static bool parseLevel(const QString &name, Level &level);
+
+    // Starts the thread that writes the messages to standard error, or to
+    // fileName. Messages logged before are written then. It stops with
+    // the application, if stop is not called before.
+    static bool start(const QString &fileName = QString());
+    // Writes the messages that are left and stops the thread.
+    static void stop();
+
+    static void warning(const char *format, ...) Q_ATTRIBUTE_FORMAT_PRINTF(1, 2);
+    static void info(const char *format, ...) Q_ATTRIBUTE_FORMAT_PRINTF(1, 2);
+    static void debug(const char *format, ...) Q_ATTRIBUTE_FORMAT_PRINTF(1, 2);
+    static void trace(const char *format, ...) Q_ATTRIBUTE_FORMAT_PRINTF(1, 2);
+    static void write(Level level, const char *format, va_list arguments);
+
+    // Messages that did not fit in the ring.
+    static quint64 droppedMessages();
+
+    // Whether contexts should be created with the debug option, and how
+    // to start a QOpenGLDebugLogger on them.
+    static bool wantsDebugContext() { return isEnabled(DEBUG); }
+    static QOpenGLDebugLogger::LoggingMode openGLLoggingMode();
+    // Connect QOpenGLDebugLogger::messageLogged to this, directly.
+    static void logOpenGLMessage(const QOpenGLDebugMessage &message);
+};
+
+#endif // EVENTLOG_H
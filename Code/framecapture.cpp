@@ -0,0 +1,119 @@
+#include "framecapture.h"
+#include "eventlog.h"
+
+#include <cstring>
+
+// Longest wait for the GPU when the frames have to be read back anyway.
+static const GLuint64 FenceTimeoutNanoseconds = 1000000000;
+
+bool FrameCapture::start(const QString &path, QSize size, int framesPerSecond)
+{
+    if (capturing) stop();
+    if (!initialized) {
+        initializeOpenGLFunctions();
+        initialized = true;
+    }
+
+    if (size.isEmpty() || !encoder.open(path, size, framesPerSecond)) {
+        EventLog::warning("Could not capture to %s", qPrintable(path));
+        return false;
+    }
+
+    this->size = size;
+    int bytes = size.width() * size.height() * 4;
+    for (Slot &slot : ring) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    first = 0;
+    inFlight = 0;
+    captured = 0;
+    dropped = 0;
+    capturing = true;
+    EventLog::info("Capturing to %s", qPrintable(path));
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    if (!capturing) return;
+
+    collect(true);
+    encoder.close();
+    for (Slot &slot : ring) {
+        glDeleteBuffers(1, &slot.buffer);
+        slot.buffer = 0;
+    }
+    capturing = false;
+
+    EventLog::info("Captured %d frames, %d dropped.", captured, dropped);
+}
+
+void FrameCapture::captureFrame()
+{
+    if (!capturing) return;
+
+    collect(false);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] != size.width() || viewport[3] != size.height()) {
+        // The output changed size, the video can not.
+        dropped++;
+        return;
+    }
+
+    if (inFlight == RingSize) {
+        if (dropFrames) {
+            dropped++;
+            return;
+        }
+        collect(true);
+    }
+
+    Slot &slot = ring[(first + inFlight) % RingSize];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(viewport[0], viewport[1], size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    inFlight++;
+}
+
+void FrameCapture::collect(bool wait)
+{
+    while (inFlight > 0) {
+        Slot &slot = ring[first];
+        GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                         wait ? FenceTimeoutNanoseconds : 0);
+        if (!wait && status == GL_TIMEOUT_EXPIRED) return;
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+        first = (first + 1) % RingSize;
+        inFlight--;
+
+        uchar *frame = status == GL_WAIT_FAILED || status == GL_TIMEOUT_EXPIRED
+                ? nullptr : encoder.acquire(!dropFrames);
+        if (!frame) {
+            dropped++;
+            continue;
+        }
+
+        int bytes = size.width() * size.height() * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+        if (pixels) {
+            std::memcpy(frame, pixels, bytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            encoder.submit(frame);
+            captured++;
+        } else {
+            encoder.release(frame);
+            dropped++;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
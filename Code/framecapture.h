@@ -0,0 +1,63 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include "frameencoder.h"
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QSize>
+#include <QString>
+
+/**
+ * @brief The FrameCapture class
+ *
+ * Records the frames that are drawn without waiting for the GPU. Each
+ * frame is read into the next of RingSize pixel buffer objects, with a
+ * fence after it. A buffer is mapped only once its fence has passed, a
+ * frame or two later, and copied to the FrameEncoder, which writes it on
+ * its own thread. When the ring or the encoder is full the frame is
+ * dropped rather than waited for, unless setDropFrames(false) is set.
+ * All functions have to be called with the OpenGL context current.
+ */
+class FrameCapture : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    static const int RingSize = 3;
+
+    // Starts writing frames of size pixels to path, see FrameEncoder::formatOf.
+    bool start(const QString &path, QSize size, int framesPerSecond = 60);
+    // Writes the frames that are still read back, and closes the output.
+    void stop();
+    bool isCapturing() const { return capturing; }
+
+    // Waits instead of dropping a frame, for offline rendering.
+    void setDropFrames(bool enabled) { dropFrames = enabled; }
+
+    // Reads the viewport of the bound framebuffer, call it after a frame is drawn.
+    void captureFrame();
+
+    int capturedFrames() const { return captured; }
+    int droppedFrames() const { return dropped; }
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        GLsync fence = 0;
+    };
+
+    // Passes the frames the GPU is done with to the encoder, all of them if wait is set.
+    void collect(bool wait);
+
+    Slot ring[RingSize];
+    // The oldest slot that is being read back and how many are.
+    int first = 0, inFlight = 0;
+
+    FrameEncoder encoder;
+    QSize size;
+    bool capturing = false;
+    bool dropFrames = true;
+    bool initialized = false;
+    int captured = 0, dropped = 0;
+};
+
+#endif // FRAMECAPTURE_H
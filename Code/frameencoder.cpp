@@ -0,0 +1,163 @@
+#include "frameencoder.h"
+#include "eventlog.h"
+
+#include <QDir>
+#include <QImage>
+
+// PNG compresses little at this quality, so the encoder keeps up with the frames.
+static const int PngQuality = 90;
+
+FrameEncoder::Format FrameEncoder::formatOf(const QString &path)
+{
+    return path.endsWith(".y4m", Qt::CaseInsensitive) ? Y4M : PNG;
+}
+
+FrameEncoder::~FrameEncoder()
+{
+    close();
+}
+
+bool FrameEncoder::open(const QString &path, QSize size, int framesPerSecond)
+{
+    format = formatOf(path);
+    this->size = size;
+    written = 0;
+    closing = false;
+
+    if (format == Y4M) {
+        // 4:2:0 has one U and V per two by two pixels, an odd last row or column is left out.
+        QSize videoSize(size.width() & ~1, size.height() & ~1);
+        file.setFileName(path);
+        if (videoSize.isEmpty() || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+        file.write(QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C420jpeg\n")
+                   .arg(videoSize.width()).arg(videoSize.height()).arg(framesPerSecond).toLatin1());
+        planes.resize(videoSize.width() * videoSize.height() * 3 / 2);
+    } else {
+        directory = path;
+        if (!QDir().mkpath(directory)) return false;
+    }
+
+    buffers.assign(QueueSize, std::vector<uchar>(size.width() * size.height() * 4));
+    freeBuffers.clear();
+    for (std::vector<uchar> &buffer : buffers) {
+        freeBuffers.push_back(buffer.data());
+    }
+    queue.clear();
+
+    start();
+    return true;
+}
+
+void FrameEncoder::close()
+{
+    if (!isRunning()) return;
+
+    mutex.lock();
+    closing = true;
+    queued.wakeOne();
+    mutex.unlock();
+    wait();
+
+    if (file.isOpen()) file.close();
+}
+
+uchar *FrameEncoder::acquire(bool wait)
+{
+    QMutexLocker locker(&mutex);
+    while (wait && freeBuffers.empty()) {
+        released.wait(&mutex);
+    }
+    if (freeBuffers.empty()) return nullptr;
+
+    uchar *frame = freeBuffers.back();
+    freeBuffers.pop_back();
+    return frame;
+}
+
+void FrameEncoder::submit(uchar *frame)
+{
+    QMutexLocker locker(&mutex);
+    queue.push_back(frame);
+    queued.wakeOne();
+}
+
+void FrameEncoder::release(uchar *frame)
+{
+    QMutexLocker locker(&mutex);
+    freeBuffers.push_back(frame);
+    released.wakeOne();
+}
+
+void FrameEncoder::run()
+{
+    forever {
+        uchar *frame;
+        {
+            QMutexLocker locker(&mutex);
+            while (queue.empty() && !closing) {
+                queued.wait(&mutex);
+            }
+            if (queue.empty()) return;
+            frame = queue.front();
+            queue.pop_front();
+        }
+
+        write(frame);
+        release(frame);
+    }
+}
+
+void FrameEncoder::write(const uchar *frame)
+{
+    if (format == Y4M) {
+        writeY4m(frame);
+    } else {
+        writePng(frame);
+    }
+    written++;
+}
+
+void FrameEncoder::writeY4m(const uchar *frame)
+{
+    int width = size.width() & ~1;
+    int height = size.height() & ~1;
+    uchar *y = planes.data();
+    uchar *u = y + width * height;
+    uchar *v = u + width * height / 4;
+
+    // Y4M starts at the top row, OpenGL at the bottom one.
+    for (int row = 0; row < height; row++) {
+        const uchar *pixel = frame + (size.height() - 1 - row) * size.width() * 4;
+        for (int column = 0; column < width; column++, pixel += 4) {
+            y[row * width + column] = static_cast<uchar>(((66 * pixel[0] + 129 * pixel[1] + 25 * pixel[2] + 128) >> 8) + 16);
+        }
+    }
+
+    // Colour of the average of every two by two pixels.
+    int stride = size.width() * 4;
+    for (int row = 0; row < height / 2; row++) {
+        const uchar *top = frame + (size.height() - 1 - 2 * row) * stride;
+        const uchar *bottom = top - stride;
+        for (int column = 0; column < width / 2; column++, top += 8, bottom += 8) {
+            int r = (top[0] + top[4] + bottom[0] + bottom[4] + 2) / 4;
+            int g = (top[1] + top[5] + bottom[1] + bottom[5] + 2) / 4;
+            int b = (top[2] + top[6] + bottom[2] + bottom[6] + 2) / 4;
+            u[row * width / 2 + column] = static_cast<uchar>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            v[row * width / 2 + column] = static_cast<uchar>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+
+    file.write("FRAME\n");
+    if (file.write(reinterpret_cast<const char*>(planes.data()), planes.size()) != static_cast<qint64>(planes.size())) {
+        EventLog::warning("Could not write a frame to %s", qPrintable(file.fileName()));
+    }
+}
+
+void FrameEncoder::writePng(const uchar *frame)
+{
+    QImage image(frame, size.width(), size.height(), size.width() * 4, QImage::Format_RGBA8888);
+    QString fileName = QString("%1/frame%2.png").arg(directory).arg(written, 5, 10, QChar('0'));
+    if (!image.mirrored().save(fileName, "PNG", PngQuality)) {
+        EventLog::warning("Could not write %s", qPrintable(fileName));
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef FRAMEENCODER_H
+#define FRAMEENCODER_H
+
+#include <QFile>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <deque>
+#include <vector>
+
+/**
+ * @brief The FrameEncoder class
+ *
+ * Writes captured frames on a thread of its own: into one Y4M video
+ * (4:2:0, BT.601), or into a directory as a PNG per frame. The frames are
+ * RGBA with the bottom row first, as OpenGL reads them. There are
+ * QueueSize frame buffers: a frame that comes while all of them wait to
+ * be written is dropped, unless the caller chooses to wait.
+ *
+ * Not a JobSystem job: the thread spends most of its time blocked on the
+ * disk, which would hold up a worker, and a Y4M stream has to be written
+ * one frame after the other anyway. It mostly sleeps, so it does not take
+ * a core from the workers.
+ */
+class FrameEncoder : public QThread
+{
+public:
+    enum Format
+    {
+        Y4M, PNG
+    };
+
+    static const int QueueSize = 8;
+
+    // A path ending in .y4m is written as Y4M, any other path is a directory for PNGs.
+    static Format formatOf(const QString &path);
+
+    ~FrameEncoder();
+
+    // Opens the output and starts the thread.
+    bool open(const QString &path, QSize size, int framesPerSecond);
+    // Writes the frames that were submitted, then stops the thread.
+    void close();
+
+    // A buffer for the next frame, size.width() * size.height() * 4 bytes.
+    // Null if every buffer waits to be written and wait is false.
+    uchar *acquire(bool wait);
+    void submit(uchar *frame);
+    // Gives a buffer back without writing it.
+    void release(uchar *frame);
+
+    int writtenFrames() const { return written; }
+
+protected:
+    void run();
+
+private:
+    void write(const uchar *frame);
+    void writeY4m(const uchar *frame);
+    void writePng(const uchar *frame);
+
+    QMutex mutex;
+    QWaitCondition queued, released;
+    std::vector<std::vector<uchar>> buffers;
+    std::vector<uchar*> freeBuffers;
+    std::deque<uchar*> queue;
+    bool closing = false;
+
+    Format format = Y4M;
+    QSize size;
+    QFile file;
+    QString directory;
+    // Y, U and V planes of one frame.
+    std::vector<uchar> planes;
+    int written = 0;
+};
+
+#endif // FRAMEENCODER_H
@@ -0,0 +1,349 @@
+#include "frameprofiler.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+// Timeline rows of the Chrome trace.
+enum TraceThread
+{
+    CPU_THREAD = 1, GPU_THREAD, UNIFORM_THREAD
+};
+
+const char *FrameProfiler::sectionName(Section section)
+{
+    switch (section) {
+        case FRAME:      return "frame";
+        case CLEAR:      return "clear";
+        case COMPOSITE:  return "composite";
+        case SHADOWS:    return "shadows";
+        case TRANSFORMS: return "transforms";
+        case UNIFORMS:   return "uniforms";
+        case BOARD:      return "board";
+        case DISKS:      return "disks";
+        case TABLE:      return "table";
+        case UPSCALE:    return "upscale";
+        default:         return "unknown";
+    }
+}
+
+bool FrameProfiler::isGpuSection(Section section)
+{
+    return section == CLEAR || section == COMPOSITE || section == SHADOWS || section == BOARD || section == DISKS || section == TABLE || section == UPSCALE;
+}
+
+void FrameProfiler::initialize()
+{
+    initializeOpenGLFunctions();
+
+    glGenQueries(FramesInFlight * SectionCount, &queries[0][0]);
+    for (int slot = 0; slot < FramesInFlight; slot++) {
+        std::fill(issued[slot], issued[slot] + SectionCount, false);
+        issuedFrame[slot] = -1;
+    }
+
+    history.assign(HistorySize, FrameSample());
+    clock.start();
+    initialized = true;
+}
+
+void FrameProfiler::destroy()
+{
+    if (!initialized) return;
+
+    glDeleteQueries(FramesInFlight * SectionCount, &queries[0][0]);
+    initialized = false;
+    enabled = false;
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (!initialized) return;
+
+    if (enabled != requestedEnabled) {
+        enabled = requestedEnabled;
+        // Results of the queries from before the profiler was paused are not needed.
+        for (int slot = 0; slot < FramesInFlight; slot++) {
+            std::fill(issued[slot], issued[slot] + SectionCount, false);
+            issuedFrame[slot] = -1;
+        }
+    }
+    if (!enabled) return;
+
+    int slot = frameCount % FramesInFlight;
+    collectQueries(slot);
+    issuedFrame[slot] = frameCount;
+
+    FrameSample &current = sample(frameCount);
+    current.frame = frameCount;
+    std::fill(current.cpuStart, current.cpuStart + SectionCount, -1);
+    std::fill(current.cpu, current.cpu + SectionCount, -1);
+    std::fill(current.gpu, current.gpu + SectionCount, -1);
+    current.renderScale = 1;
+
+    beginSection(FRAME);
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!enabled) return;
+
+    endSection(FRAME);
+    frameCount++;
+}
+
+void FrameProfiler::beginSection(Section section)
+{
+    FrameSample &current = sample(frameCount);
+    qint64 now = clock.nsecsElapsed();
+
+    if (current.cpuStart[section] < 0) {
+        current.cpuStart[section] = now;
+    }
+    runStart[section] = now;
+
+    if (isGpuSection(section)) {
+        int slot = frameCount % FramesInFlight;
+        glBeginQuery(GL_TIME_ELAPSED, queries[slot][section]);
+        issued[slot][section] = true;
+    }
+}
+
+void FrameProfiler::endSection(Section section)
+{
+    FrameSample &current = sample(frameCount);
+    qint64 elapsed = clock.nsecsElapsed() - runStart[section];
+    current.cpu[section] = qMax<qint64>(current.cpu[section], 0) + elapsed;
+
+    if (isGpuSection(section)) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+}
+
+// Reads the results of the frame that used this set of queries before.
+void FrameProfiler::collectQueries(int slot)
+{
+    if (issuedFrame[slot] < 0) return;
+
+    FrameSample &old = sample(issuedFrame[slot]);
+    bool complete = true;
+    qint64 total = 0;
+
+    for (int section = 0; section < SectionCount; section++) {
+        if (!issued[slot][section]) continue;
+        issued[slot][section] = false;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][section], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            complete = false;
+            continue;
+        }
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[slot][section], GL_QUERY_RESULT, &nanoseconds);
+        old.gpu[section] = static_cast<qint64>(nanoseconds);
+        total += old.gpu[section];
+    }
+
+    // The GPU time of the whole frame is the sum of its sections.
+    if (complete) {
+        old.gpu[FRAME] = total;
+    }
+}
+
+FrameProfiler::Statistics FrameProfiler::cpuStatistics(Section section) const
+{
+    return statistics(section, false);
+}
+
+FrameProfiler::Statistics FrameProfiler::gpuStatistics(Section section) const
+{
+    return statistics(section, true);
+}
+
+FrameProfiler::Statistics FrameProfiler::statistics(Section section, bool gpu) const
+{
+    std::vector<double> values;
+    values.reserve(history.size());
+    for (const FrameSample &frame : history) {
+        qint64 value = gpu ? frame.gpu[section] : frame.cpu[section];
+        if (frame.frame >= 0 && value >= 0) {
+            values.push_back(value / 1e6);
+        }
+    }
+
+    Statistics result;
+    if (values.empty()) return result;
+
+    std::sort(values.begin(), values.end());
+    int count = static_cast<int>(values.size());
+    double sum = 0;
+    for (double value : values) sum += value;
+
+    result.samples = count;
+    result.mean = sum / count;
+    result.p50 = values[qMin(count - 1, int(0.50 * count))];
+    result.p95 = values[qMin(count - 1, int(0.95 * count))];
+    result.p99 = values[qMin(count - 1, int(0.99 * count))];
+    return result;
+}
+
+void FrameProfiler::renderScales(float &lowest, float &last) const
+{
+    lowest = last = 1;
+    for (const FrameSample &frame : history) {
+        if (frame.frame >= 0) lowest = qMin(lowest, frame.renderScale);
+    }
+    if (frameCount > 0 && history[(frameCount - 1) % HistorySize].frame == frameCount - 1) {
+        last = history[(frameCount - 1) % HistorySize].renderScale;
+    }
+}
+
+QString FrameProfiler::overlayText() const
+{
+    QString text = QString("%1 ms          p50    p95    p99\n").arg("", -10);
+    for (int i = 0; i < SectionCount; i++) {
+        Section section = static_cast<Section>(i);
+        Statistics cpu = cpuStatistics(section);
+        text += QString("%1 cpu  %2 %3 %4\n").arg(sectionName(section), -10)
+                .arg(cpu.p50, 6, 'f', 2).arg(cpu.p95, 6, 'f', 2).arg(cpu.p99, 6, 'f', 2);
+
+        if (isGpuSection(section) || section == FRAME) {
+            Statistics gpu = gpuStatistics(section);
+            text += QString("%1 gpu  %2 %3 %4\n").arg("", -10)
+                    .arg(gpu.p50, 6, 'f', 2).arg(gpu.p95, 6, 'f', 2).arg(gpu.p99, 6, 'f', 2);
+        }
+    }
+
+    float lowest, last;
+    renderScales(lowest, last);
+    text += QString("render scale %1, lowest %2\n").arg(last, 0, 'f', 2).arg(lowest, 0, 'f', 2);
+    return text;
+}
+
+static QJsonObject statisticsToJson(const FrameProfiler::Statistics &statistics)
+{
+    QJsonObject object;
+    object["samples"] = statistics.samples;
+    object["mean"] = statistics.mean;
+    object["p50"] = statistics.p50;
+    object["p95"] = statistics.p95;
+    object["p99"] = statistics.p99;
+    return object;
+}
+
+static bool writeJson(const QString &fileName, const QJsonObject &object)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return file.write(QJsonDocument(object).toJson()) >= 0;
+}
+
+bool FrameProfiler::writeSummary(const QString &fileName) const
+{
+    QJsonObject sections;
+    for (int i = 0; i < SectionCount; i++) {
+        Section section = static_cast<Section>(i);
+        QJsonObject times;
+        times["cpu"] = statisticsToJson(cpuStatistics(section));
+        if (isGpuSection(section) || section == FRAME) {
+            times["gpu"] = statisticsToJson(gpuStatistics(section));
+        }
+        sections[sectionName(section)] = times;
+    }
+
+    float lowest, last;
+    renderScales(lowest, last);
+    QJsonObject renderScale;
+    renderScale["lowest"] = lowest;
+    renderScale["last"] = last;
+
+    QJsonObject summary;
+    summary["frames"] = frameCount;
+    summary["renderScale"] = renderScale;
+    summary["unit"] = QString("ms");
+    summary["sections"] = sections;
+    return writeJson(fileName, summary);
+}
+
+static QJsonObject traceEvent(const char *name, int thread, double start, double duration)
+{
+    QJsonObject event;
+    event["name"] = QString(name);
+    event["ph"] = QString("X");
+    event["pid"] = 1;
+    event["tid"] = thread;
+    event["ts"] = start;
+    event["dur"] = duration;
+    return event;
+}
+
+static QJsonObject counterEvent(const char *name, double time, double value)
+{
+    QJsonObject args;
+    args["value"] = value;
+
+    QJsonObject event;
+    event["name"] = QString(name);
+    event["ph"] = QString("C");
+    event["pid"] = 1;
+    event["ts"] = time;
+    event["args"] = args;
+    return event;
+}
+
+static QJsonObject threadName(int thread, const char *name)
+{
+    QJsonObject args;
+    args["name"] = QString(name);
+
+    QJsonObject event;
+    event["name"] = QString("thread_name");
+    event["ph"] = QString("M");
+    event["pid"] = 1;
+    event["tid"] = thread;
+    event["args"] = args;
+    return event;
+}
+
+bool FrameProfiler::writeTrace(const QString &fileName) const
+{
+    QJsonArray events;
+    events.append(threadName(CPU_THREAD, "CPU"));
+    events.append(threadName(GPU_THREAD, "GPU"));
+    events.append(threadName(UNIFORM_THREAD, "CPU uniform uploads (summed)"));
+
+    // Times in the trace are in microseconds.
+    for (qint64 frame = qMax<qint64>(0, frameCount - HistorySize); frame < frameCount; frame++) {
+        const FrameSample &current = history[frame % HistorySize];
+        if (current.frame != frame) continue;
+
+        for (int i = 0; i < SectionCount; i++) {
+            Section section = static_cast<Section>(i);
+            if (current.cpu[section] < 0) continue;
+            events.append(traceEvent(sectionName(section), section == UNIFORMS ? UNIFORM_THREAD : CPU_THREAD,
+                                     current.cpuStart[section] / 1e3, current.cpu[section] / 1e3));
+        }
+
+        events.append(counterEvent("render scale", current.cpuStart[FRAME] / 1e3, current.renderScale));
+
+        // Only the durations are known on the GPU, the sections are placed
+        // one after the other from the start of the frame.
+        double gpuTime = current.cpuStart[FRAME] / 1e3;
+        for (int i = 0; i < SectionCount; i++) {
+            Section section = static_cast<Section>(i);
+            if (!isGpuSection(section) || current.gpu[section] < 0) continue;
+            events.append(traceEvent(sectionName(section), GPU_THREAD, gpuTime, current.gpu[section] / 1e3));
+            gpuTime += current.gpu[section] / 1e3;
+        }
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = QString("ms");
+    return writeJson(fileName, trace);
+}
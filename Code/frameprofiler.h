@@ -0,0 +1,137 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QElapsedTimer>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief The FrameProfiler class
+ *
+ * Measures how long the sections of a frame take, on the CPU with a clock
+ * and on the GPU with GL_TIME_ELAPSED queries. The query results of a frame
+ * are read FramesInFlight frames later, when the GPU is done with them, so
+ * measuring never waits for the GPU. A result that is still not available
+ * then is dropped.
+ *
+ * The last HistorySize frames are kept for the percentiles, the overlay
+ * text and the JSON and Chrome trace dumps.
+ */
+class FrameProfiler : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    enum Section
+    {
+        FRAME = 0,  // CPU only: everything between beginFrame and endFrame
+        CLEAR,
+        COMPOSITE,  // Copying the static layer
+        SHADOWS,    // Drawing the shadow map
+        TRANSFORMS, // CPU only
+        UNIFORMS,   // CPU only, summed over all draws
+        BOARD,
+        DISKS,
+        TABLE,
+        UPSCALE,    // Scaling the scene up to the window, with dynamic resolution
+        SectionCount
+    };
+
+    static const int FramesInFlight = 3;
+    static const int HistorySize = 512;
+
+    struct Statistics
+    {
+        int samples = 0;
+        double mean = 0, p50 = 0, p95 = 0, p99 = 0; // Milliseconds
+    };
+
+    static const char *sectionName(Section section);
+    // Sections that are also timed on the GPU. These may not overlap and
+    // run at most once a frame.
+    static bool isGpuSection(Section section);
+
+    // Creates the queries, needs a current context.
+    void initialize();
+    void destroy();
+
+    // Takes effect at the next frame.
+    void setEnabled(bool enabled) { requestedEnabled = enabled; }
+    bool isEnabled() const { return requestedEnabled; }
+
+    void beginFrame();
+    void endFrame();
+
+    void begin(Section section) { if (enabled) beginSection(section); }
+    void end(Section section) { if (enabled) endSection(section); }
+
+    // Fraction of the window size the scene of this frame is drawn at.
+    void setRenderScale(float scale) { if (enabled) sample(frameCount).renderScale = scale; }
+
+    Statistics cpuStatistics(Section section) const;
+    Statistics gpuStatistics(Section section) const;
+
+    // A few lines with the percentiles of every section.
+    QString overlayText() const;
+
+    // Percentiles of every section as JSON.
+    bool writeSummary(const QString &fileName) const;
+    // The frames in the history in the Chrome trace event format, to open
+    // in chrome://tracing or Perfetto.
+    bool writeTrace(const QString &fileName) const;
+
+private:
+    struct FrameSample
+    {
+        qint64 frame = -1;
+        qint64 cpuStart[SectionCount]; // Nanoseconds since initialize
+        qint64 cpu[SectionCount];      // Nanoseconds, -1 if not measured
+        qint64 gpu[SectionCount];
+        float renderScale = 1;
+    };
+
+    void beginSection(Section section);
+    void endSection(Section section);
+    void collectQueries(int slot);
+
+    Statistics statistics(Section section, bool gpu) const;
+    // The lowest render scale in the history and the one of the last frame.
+    void renderScales(float &lowest, float &last) const;
+    FrameSample &sample(qint64 frame) { return history[frame % HistorySize]; }
+
+    bool enabled = false;
+    bool requestedEnabled = false;
+    bool initialized = false;
+
+    QElapsedTimer clock;
+    qint64 frameCount = 0;
+    std::vector<FrameSample> history;
+    // Start of the current run of every section, a section can run more than once a frame.
+    qint64 runStart[SectionCount];
+
+    // One set of queries per frame in flight.
+    GLuint queries[FramesInFlight][SectionCount];
+    bool issued[FramesInFlight][SectionCount];
+    qint64 issuedFrame[FramesInFlight];
+};
+
+/**
+ * @brief The ProfileScope class
+ *
+ * Times a section until the end of the scope.
+ */
+class ProfileScope
+{
+public:
+    ProfileScope(FrameProfiler &profiler, FrameProfiler::Section section)
+        : profiler(profiler), section(section)
+    {
+        profiler.begin(section);
+    }
+    ~ProfileScope() { profiler.end(section); }
+
+private:
+    FrameProfiler &profiler;
+    FrameProfiler::Section section;
+};
+
+#endif // FRAMEPROFILER_H
@@ -0,0 +1,211 @@
+#include "game.h"
+#include "eventlog.h"
+
+
+// Distance between the centres of two columns and two rows of holes, and
+// height of the centre between the 3rd and 4th row, on the 7 x 6 model.
+static const float ModelColumnSpacing = 0.58f;
+static const float ModelRowSpacing = 0.42f;
+static const float ModelCentreHeight = 0.05f;
+
+// The same on the stretched board, spread over the columns and rows played.
+static const float ColumnSpacing = ModelColumnSpacing * 7 * BoardStretchX / GameBoard::Columns;
+static const float RowSpacing = ModelRowSpacing * 6 * BoardStretchY / GameBoard::Rows;
+static const float BoardCentreHeight = ModelCentreHeight * BoardStretchY;
+
+// Disks are dropped this far above where they land and fall for a second.
+static const float DropHeight = 7.2f;
+static const float Gravity = 2 * DropHeight;
+// The simulation runs in steps of this many seconds.
+static const double SimulationStep = 1 / 120.0;
+// At most this many seconds are simulated at once, a long stall is not caught up.
+static const double MaxAdvance = 0.25;
+// Part of its speed a bouncing disk keeps, and the speed under which it stays down.
+static const float Restitution = 0.3f;
+static const float RestSpeed = 0.5f;
+
+Game::Game()
+{
+    record.columns = GameBoard::Columns;
+    record.rows = GameBoard::Rows;
+    record.inARow = GameBoard::InARow;
+}
+
+Game::~Game()
+{
+    saveRecord();
+}
+
+void Game::clear()
+{
+    saveRecord();
+
+    game.clear();
+    state.diskCount = 0;
+    state.gameWinner = '0';
+
+    record.clear();
+    record.yellowFirst = state.yellowPlayer;
+    updateHover();
+}
+
+void Game::dropDisk(int column)
+{
+    int indexedColumn = column - 1;
+
+    if(state.gameWinner == 'y' || state.gameWinner == 'r'){
+        EventLog::info("Game over! Press 0 or R to play another game.");
+    } else {
+        if(game.canPlay(indexedColumn)){
+            // A new move replaces the moves that could still be redone.
+            record.moves.resize(game.moveCount());
+            record.moves.push_back(indexedColumn);
+
+            playMove(indexedColumn);
+        } else {
+            EventLog::info("You can't play here. Column %d is full.", column);
+        }
+    }
+}
+
+void Game::playMove(int indexedColumn)
+{
+    // Calculations that are needed for the object transform matrix
+    float x = (indexedColumn - (GameBoard::Columns - 1) / 2.0f) * ColumnSpacing;
+    float y = BoardCentreHeight + (game.height(indexedColumn) - (GameBoard::Rows - 1) / 2.0f) * RowSpacing;
+
+    EventLog::info("%s played in column: %d", state.yellowPlayer ? "Yellow" : "Red", indexedColumn + 1);
+    Disk &disk = state.disks[game.moveCount()];
+    disk = Disk(x, y, state.yellowPlayer);
+    disk.height = disk.previousHeight = DropHeight;
+    disk.landed = false;
+
+    switch (game.play(indexedColumn)){
+        case GameBoard::UNFINISHED:
+            break;
+        case GameBoard::WON:
+            state.gameWinner = state.yellowPlayer ? 'y' : 'r';
+            // The first player made all odd numbered moves.
+            record.result = game.moveCount() % 2 ? GameRecord::FIRST_WON : GameRecord::SECOND_WON;
+            EventLog::info("Congratulations! You won!");
+            break;
+        case GameBoard::DRAW:
+            state.gameWinner = 'd';
+            record.result = GameRecord::DRAW;
+            break;
+    }
+    state.diskCount = game.moveCount();
+
+    // Turn completed. Switch turn to other player.
+    state.yellowPlayer = !state.yellowPlayer;
+    updateHover();
+}
+
+// Takes back the last move. Only the disk count goes down, the disk
+// itself is simply no longer drawn.
+void Game::undoMove()
+{
+    if (game.moveCount() == 0) return;
+
+    game.undo(record.moves[game.moveCount() - 1]);
+    state.diskCount = game.moveCount();
+    state.yellowPlayer = !state.yellowPlayer;
+    state.gameWinner = '0';
+    record.result = GameRecord::UNFINISHED;
+    updateHover();
+}
+
+// Plays the last move that was taken back again.
+void Game::redoMove()
+{
+    if (game.isGameOver() || game.moveCount() >= static_cast<int>(record.moves.size())) return;
+
+    playMove(record.moves[game.moveCount()]);
+}
+
+void Game::advance(double seconds)
+{
+    advance(state, unsimulated, seconds, bounce);
+}
+
+void Game::advance(SceneState &scene, double &unsimulated, double seconds, bool bounce)
+{
+    unsimulated = qMin(unsimulated + seconds, MaxAdvance);
+    while (unsimulated >= SimulationStep) {
+        simulate(scene, SimulationStep, bounce);
+        unsimulated -= SimulationStep;
+    }
+    scene.interpolation = static_cast<float>(unsimulated / SimulationStep);
+}
+
+void Game::simulate(SceneState &scene, float seconds, bool bounce)
+{
+    for (int i = 0; i < scene.diskCount; i++) {
+        Disk &disk = scene.disks[i];
+        disk.previousHeight = disk.height;
+        if (disk.landed) continue;
+
+        disk.speed += Gravity * seconds;
+        disk.height -= disk.speed * seconds;
+        if (disk.height > 0) continue;
+
+        disk.height = 0;
+        if (bounce && disk.speed * Restitution > RestSpeed) {
+            disk.speed = -disk.speed * Restitution;
+        } else {
+            disk.speed = 0;
+            disk.landed = true;
+        }
+    }
+}
+
+int Game::columnAt(float x) const
+{
+    int indexedColumn = qRound(x / ColumnSpacing + (GameBoard::Columns - 1) / 2.0f);
+    return indexedColumn >= 0 && indexedColumn < GameBoard::Columns ? indexedColumn + 1 : 0;
+}
+
+void Game::setHoverColumn(int column)
+{
+    hoverColumn = column;
+    updateHover();
+}
+
+// A full column or a finished game has nowhere to drop a disk.
+void Game::updateHover()
+{
+    int indexedColumn = hoverColumn - 1;
+    state.hovering = hoverColumn > 0 && !game.isGameOver() && game.canPlay(indexedColumn);
+    if (!state.hovering) return;
+
+    // Two rows above the top row.
+    float x = (indexedColumn - (GameBoard::Columns - 1) / 2.0f) * ColumnSpacing;
+    float y = BoardCentreHeight + (GameBoard::Rows + 1 - (GameBoard::Rows - 1) / 2.0f) * RowSpacing;
+    state.hoverDisk = Disk(x, y, state.yellowPlayer);
+}
+
+void Game::setRecordFile(QString fileName)
+{
+    recordWriter.reset();
+    recordFile.close();
+
+    recordFile.open(fileName.toLocal8Bit().constData(), std::ios::binary | std::ios::trunc);
+    if (!recordFile) {
+        EventLog::warning("Could not open the record file %s", qPrintable(fileName));
+        return;
+    }
+    recordWriter.reset(new GameRecordWriter(recordFile));
+}
+
+// Appends the current game to the record file, if there is one.
+void Game::saveRecord()
+{
+    if (!recordWriter || game.moveCount() == 0) return;
+
+    // Moves that were taken back are not part of the game.
+    record.moves.resize(game.moveCount());
+    if (!recordWriter->write(record)) {
+        EventLog::warning("Could not write the game record.");
+    }
+    recordFile.flush();
+}
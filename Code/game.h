@@ -0,0 +1,107 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "board.h"
+#include "disk.h"
+#include "gamerecord.h"
+
+#include <QString>
+#include <fstream>
+#include <memory>
+
+// The board variant that is played, see board.h for the available ones.
+typedef Board<7, 6, 4> GameBoard;
+
+// The board model has 7 x 6 holes, the renderer stretches it by these
+// factors to the board that is played. The disks are placed on the
+// stretched board.
+static const float BoardStretchX = GameBoard::Columns / 7.0f;
+static const float BoardStretchY = GameBoard::Rows / 6.0f;
+
+/**
+ * @brief The SceneState struct
+ *
+ * Everything the renderer needs to know about the game.
+ */
+struct SceneState
+{
+    Disk disks[GameBoard::Cells];
+    int diskCount = 0;
+    bool yellowPlayer = true;
+    char gameWinner = '0';
+
+    // How far the simulation is between its last two steps, from 0 to 1.
+    float interpolation = 0;
+
+    // The disk that shows where the mouse would drop one, above the board.
+    bool hovering = false;
+    Disk hoverDisk;
+};
+
+/**
+ * @brief The Game class
+ *
+ * One game as it is shown: the rules, the disks that were dropped, whose
+ * turn it is, and the record of the moves played.
+ * Used by MainView and by the headless renderer.
+ */
+class Game
+{
+public:
+    Game();
+    ~Game();
+
+    // Empties the board. The player to move is kept, so resetting can be
+    // used to let the other colour make the first move.
+    void clear();
+
+    // Drops a disk in column (1 indexed), it starts falling at the next advance.
+    void dropDisk(int column);
+    void undoMove();
+    void redoMove();
+
+    // Moves the falling disks on by the time that passed, in fixed steps
+    // so the animation does not depend on the frame rate.
+    void advance(double seconds);
+    // Disks bounce a few times before they come to rest.
+    void setBounce(bool enabled) { bounce = enabled; }
+    // Time that has passed since the last step of the simulation.
+    double unsimulatedSeconds() const { return unsimulated; }
+
+    // Moves a copy of the scene on the same way, for a thread that animates
+    // it on its own. unsimulated is carried from one call to the next.
+    static void advance(SceneState &scene, double &unsimulated, double seconds, bool bounce);
+
+    // Column (1 indexed) at a horizontal position in the world, 0 if that is not over the board.
+    int columnAt(float x) const;
+    // Shows a disk above the column (1 indexed) while a disk can be dropped there, 0 shows none.
+    void setHoverColumn(int column);
+
+    // Every finished or reset game is appended to this file.
+    void setRecordFile(QString fileName);
+
+    const SceneState &scene() const { return state; }
+    const GameBoard &board() const { return game; }
+    const GameRecord &currentRecord() const { return record; }
+
+private:
+    void playMove(int indexedColumn);
+    static void simulate(SceneState &scene, float seconds, bool bounce);
+    void updateHover();
+    void saveRecord();
+
+    GameBoard game;
+    SceneState state;
+    int hoverColumn = 0;
+
+    // Time that has passed but is less than a simulation step.
+    double unsimulated = 0;
+    bool bounce = false;
+
+    // Moves of the current game, including the ones that can be redone.
+    GameRecord record;
+    std::ofstream recordFile;
+    std::unique_ptr<GameRecordWriter> recordWriter;
+};
+
+#endif // GAME_H
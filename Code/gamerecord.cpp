@@ -0,0 +1,135 @@
+#include "gamerecord.h"
+
+#include <cstring>
+
+static const char ArchiveMagic[4] = {'C', '4', 'R', 'A'};
+static const char ArchiveVersion = 1;
+static const size_t ReadBufferSize = 1 << 20;
+// Moves are 4 bits, so a board has at most 16 columns, and a game at most
+// a move per cell. 16 * 255 moves fit in the 14 bits of two varint bytes.
+static const int MaxColumns = 16;
+static const int MaxCountShift = 7;
+
+// --- Writer
+
+GameRecordWriter::GameRecordWriter(std::ostream &stream)
+    : stream(stream)
+{
+    stream.write(ArchiveMagic, sizeof(ArchiveMagic));
+    stream.put(ArchiveVersion);
+}
+
+bool GameRecordWriter::write(const GameRecord &record)
+{
+    buffer.clear();
+    buffer.push_back(char(record.columns));
+    buffer.push_back(char(record.rows));
+    buffer.push_back(char(record.inARow));
+    buffer.push_back(char((record.result & 3) | (record.yellowFirst ? 4 : 0)));
+
+    size_t count = record.moves.size();
+    do {
+        uint8_t byte = count & 0x7F;
+        count >>= 7;
+        buffer.push_back(char(count ? byte | 0x80 : byte));
+    } while (count);
+
+    for (size_t i = 0; i < record.moves.size(); i += 2) {
+        uint8_t low = record.moves[i] & 0x0F;
+        uint8_t high = i + 1 < record.moves.size() ? record.moves[i + 1] & 0x0F : 0;
+        buffer.push_back(char(low | (high << 4)));
+    }
+
+    stream.write(buffer.data(), buffer.size());
+    return bool(stream);
+}
+
+// --- Reader
+
+GameRecordReader::GameRecordReader(std::istream &stream)
+    : stream(stream), buffer(ReadBufferSize)
+{
+    if (!fill(sizeof(ArchiveMagic) + 1)
+            || std::memcmp(buffer.data(), ArchiveMagic, sizeof(ArchiveMagic)) != 0
+            || buffer[sizeof(ArchiveMagic)] != ArchiveVersion) {
+        error = true;
+        return;
+    }
+    position += sizeof(ArchiveMagic) + 1;
+    consumed += sizeof(ArchiveMagic) + 1;
+}
+
+// Makes sure count bytes are buffered, reading more from the stream when needed.
+bool GameRecordReader::fill(size_t count)
+{
+    if (size - position >= count) return true;
+
+    // Move what is left to the front and read behind it.
+    std::memmove(buffer.data(), buffer.data() + position, size - position);
+    size -= position;
+    position = 0;
+
+    if (buffer.size() < count) buffer.resize(count);
+
+    while (size < count && stream) {
+        stream.read(buffer.data() + size, buffer.size() - size);
+        size += stream.gcount();
+    }
+    return size >= count;
+}
+
+bool GameRecordReader::read(GameRecord &record)
+{
+    if (error) return false;
+
+    // Header and the first byte of the move count.
+    if (!fill(5)) {
+        // A clean end of the archive is not an error.
+        error = size != position;
+        return false;
+    }
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(buffer.data() + position);
+    record.columns = bytes[0];
+    record.rows = bytes[1];
+    record.inARow = bytes[2];
+    record.result = bytes[3] & 3;
+    record.yellowFirst = (bytes[3] & 4) != 0;
+
+    size_t used = 4;
+    size_t count = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (shift > MaxCountShift || !fill(used + 1)) {
+            error = true;
+            return false;
+        }
+        bytes = reinterpret_cast<const uint8_t *>(buffer.data() + position);
+        uint8_t byte = bytes[used++];
+        count |= size_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+
+    // Checked before the moves are buffered, a corrupt count could be huge.
+    if (record.columns == 0 || record.columns > MaxColumns || record.rows == 0 ||
+            count > size_t(record.columns) * record.rows) {
+        error = true;
+        return false;
+    }
+    size_t packedSize = (count + 1) / 2;
+    if (!fill(used + packedSize)) {
+        error = true;
+        return false;
+    }
+    bytes = reinterpret_cast<const uint8_t *>(buffer.data() + position + used);
+
+    record.moves.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t byte = bytes[i / 2];
+        record.moves[i] = (i % 2) ? byte >> 4 : byte & 0x0F;
+    }
+
+    used += packedSize;
+    position += used;
+    consumed += used;
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief The GameRecord struct
+ *
+ * A game as the sequence of (0 indexed) columns played, plus a header
+ * with the board variant and the result.
+ *
+ * In a file, a record takes 4 header bytes, the number of moves as a
+ * variable length integer and then 4 bits per move, so a full game on
+ * the standard board fits in 26 bytes:
+ *
+ *   byte 0     columns
+ *   byte 1     rows
+ *   byte 2     disks in a row needed to win
+ *   byte 3     bit 0-1: Result, bit 2: yellow moved first
+ *   varint     number of moves, 7 bits per byte, low bits first
+ *   moves      two moves per byte, the first one in the low nibble
+ *
+ * An archive file starts with the 4 bytes "C4RA" and a version byte,
+ * followed by any number of records.
+ */
+struct GameRecord
+{
+    enum Result : uint8_t
+    {
+        UNFINISHED = 0, FIRST_WON, SECOND_WON, DRAW
+    };
+
+    uint8_t columns = 7;
+    uint8_t rows = 6;
+    uint8_t inARow = 4;
+    uint8_t result = UNFINISHED;
+    bool yellowFirst = true;
+    std::vector<uint8_t> moves;
+
+    void clear() { result = UNFINISHED; moves.clear(); }
+};
+
+// Writes records to a stream, starting with the archive header.
+class GameRecordWriter
+{
+public:
+    explicit GameRecordWriter(std::ostream &stream);
+
+    bool write(const GameRecord &record);
+    bool hasError() const { return !stream; }
+
+private:
+    std::ostream &stream;
+    std::vector<char> buffer;
+};
+
+// Reads the records written by GameRecordWriter one at a time, through
+// a large buffer, so the records can be reused without allocating.
+class GameRecordReader
+{
+public:
+    explicit GameRecordReader(std::istream &stream);
+
+    // Returns false at the end of the stream or on a malformed record.
+    bool read(GameRecord &record);
+    bool hasError() const { return error; }
+
+    // Number of bytes consumed so far.
+    long long bytesRead() const { return consumed; }
+
+private:
+    bool fill(size_t count);
+
+    std::istream &stream;
+    std::vector<char> buffer;
+    size_t position = 0;
+    size_t size = 0;
+    long long consumed = 0;
+    bool error = false;
+};
+
+#endif // GAMERECORD_H
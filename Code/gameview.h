@@ -0,0 +1,32 @@
+#ifndef GAMEVIEW_H
+#define GAMEVIEW_H
+
+#include "scenerenderer.h"
+
+#include <QString>
+
+/**
+ * @brief The GameView class
+ *
+ * What MainWindow and main.cpp set on the view of the game. MainView
+ * draws it on the GUI thread, RenderWindow on a thread of its own.
+ */
+class GameView
+{
+public:
+    virtual ~GameView() {}
+
+    virtual void setRotation(int rotateX, int rotateY, int rotateZ) = 0;
+    virtual void setShadingMode(SceneRenderer::ShadingMode shading) = 0;
+    virtual void setShadowMode(SceneRenderer::ShadowMode mode) = 0;
+    virtual void setDynamicResolution(bool enabled, float budgetMilliseconds) = 0;
+    virtual void setIncrementalRendering(bool enabled) = 0;
+    virtual void setLowLatency(bool enabled) = 0;
+    virtual void setBounce(bool enabled) = 0;
+    virtual void setProfiling(bool enabled) = 0;
+    virtual void setRecordFile(QString fileName) = 0;
+    // F9 starts and stops recording the frames to this file, see FrameEncoder::formatOf.
+    virtual void setCaptureFile(QString fileName) = 0;
+};
+
+#endif // GAMEVIEW_H
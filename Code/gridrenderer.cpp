@@ -0,0 +1,348 @@
+#include "gridrenderer.h"
+#include "assetbundle.h"
+#include "jobsystem.h"
+
+#include <QImage>
+#include <QtMath>
+#include <cmath>
+
+// Vertical field of view of the camera, in degrees.
+static const float FieldOfView = 45;
+// Space around every board, as a part of its size.
+static const float Spacing = 0.15f;
+// Room around the wall when all of it is in view.
+static const float Margin = 1.05f;
+
+void GridRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+
+    ShaderVariants::Key key = ShaderVariants::PHONG | ShaderVariants::TEXTURED | ShaderVariants::INSTANCED;
+    shaders.build(key);
+    shader = &shaders.variant(key);
+
+    QVector<float> boardVertices = AssetBundle::shared().mesh("models/connect4text.obj");
+    modelMinimum = modelMaximum = QVector3D(boardVertices[0], boardVertices[1], boardVertices[2]);
+    for (int i = 0; i < boardVertices.size(); i += 8) {
+        QVector3D position(boardVertices[i], boardVertices[i + 1], boardVertices[i + 2]);
+        modelMinimum = QVector3D(qMin(modelMinimum.x(), position.x()), qMin(modelMinimum.y(), position.y()), qMin(modelMinimum.z(), position.z()));
+        modelMaximum = QVector3D(qMax(modelMaximum.x(), position.x()), qMax(modelMaximum.y(), position.y()), qMax(modelMaximum.z(), position.z()));
+    }
+    loadMesh(boardVertices, boardVAO, boardVBO, boardSize);
+    loadMesh(boxVertices(), boxVAO, boxVBO, boxSize);
+
+    loadMesh(AssetBundle::shared().mesh("models/disktext.obj"), diskVAO, diskVBO, diskSize);
+
+    glGenBuffers(1, &instanceVBO);
+
+    // Decoded at the same time, and uploaded one after the other.
+    const char *textureFiles[] = {"textures/blue2.png", "textures/yellow2.png", "textures/red2.png",
+                                  "textures/grey2.png", "textures/yellow.png", "textures/red.png"};
+    GLuint *textures[] = {&blueTexture, &yellowTexture, &redTexture, &greyTexture, &yellowDiskTexture, &redDiskTexture};
+    QImage images[6];
+    JobSystem::instance().parallelFor("decode texture", 0, 6, 1, [&](int i) {
+        images[i] = AssetBundle::shared().image(textureFiles[i]);
+    });
+    for (int i = 0; i < 6; i++) {
+        loadTexture(images[i], *textures[i]);
+    }
+
+    // The same size and disk transform as SceneRenderer uses.
+    boardScale = QVector3D(2 * BoardStretchX, 2 * BoardStretchY, 2);
+    boardMinimum = modelMinimum * boardScale;
+    boardMaximum = modelMaximum * boardScale;
+    QVector3D boardSize = boardMaximum - boardMinimum;
+    pitch = QVector2D(boardSize.x(), boardSize.y()) * (1 + Spacing);
+    boardRadius = boardSize.length() / 2;
+
+    diskTransform.setToIdentity();
+    diskTransform.rotate(90.0, QVector3D(1.0f, 0.0f, 0.0f));
+    diskTransform.scale(0.2f);
+
+    GLuint boardTextures[] = {blueTexture, yellowTexture, redTexture, greyTexture};
+    for (int i = 0; i < 4; i++) {
+        batches[BOARD_BLUE + i].VAO = boardVAO;
+        batches[BOARD_BLUE + i].size = boardSize;
+        batches[BOARD_BLUE + i].texture = boardTextures[i];
+        batches[BOX_BLUE + i].VAO = boxVAO;
+        batches[BOX_BLUE + i].size = boxSize;
+        batches[BOX_BLUE + i].texture = boardTextures[i];
+    }
+    batches[DISK_YELLOW].VAO = batches[DISK_RED].VAO = diskVAO;
+    batches[DISK_YELLOW].size = batches[DISK_RED].size = diskSize;
+    batches[DISK_YELLOW].texture = yellowDiskTexture;
+    batches[DISK_RED].texture = redDiskTexture;
+
+    frameProfiler.initialize();
+}
+
+void GridRenderer::destroy()
+{
+    GLuint textures[] = {blueTexture, yellowTexture, redTexture, greyTexture, yellowDiskTexture, redDiskTexture};
+    glDeleteTextures(6, textures);
+
+    GLuint buffers[] = {boardVBO, boxVBO, diskVBO, instanceVBO};
+    glDeleteBuffers(4, buffers);
+    GLuint arrays[] = {boardVAO, boxVAO, diskVAO};
+    glDeleteVertexArrays(3, arrays);
+
+    shaders.destroy();
+    frameProfiler.destroy();
+}
+
+void GridRenderer::loadMesh(const QVector<float> &vertices, GLuint &VAO, GLuint &VBO, GLuint &size)
+{
+    size = vertices.size() / 8;
+
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+    // Position, normal and texture coordinates, as SceneRenderer::loadModel.
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // The model transform of the instance, a column per location. Where
+    // it is in the instance buffer is set for every draw.
+    for (int column = 0; column < 4; column++) {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// A box around the board model, with the same vertex layout as a model.
+QVector<float> GridRenderer::boxVertices() const
+{
+    QVector3D a = modelMinimum, b = modelMaximum;
+    // Corners of every face counter clockwise seen from outside, and its normal.
+    QVector3D faces[6][5] = {
+        {{a.x(), a.y(), b.z()}, {b.x(), a.y(), b.z()}, {b.x(), b.y(), b.z()}, {a.x(), b.y(), b.z()}, {0, 0, 1}},
+        {{b.x(), a.y(), a.z()}, {a.x(), a.y(), a.z()}, {a.x(), b.y(), a.z()}, {b.x(), b.y(), a.z()}, {0, 0, -1}},
+        {{b.x(), a.y(), b.z()}, {b.x(), a.y(), a.z()}, {b.x(), b.y(), a.z()}, {b.x(), b.y(), b.z()}, {1, 0, 0}},
+        {{a.x(), a.y(), a.z()}, {a.x(), a.y(), b.z()}, {a.x(), b.y(), b.z()}, {a.x(), b.y(), a.z()}, {-1, 0, 0}},
+        {{a.x(), b.y(), b.z()}, {b.x(), b.y(), b.z()}, {b.x(), b.y(), a.z()}, {a.x(), b.y(), a.z()}, {0, 1, 0}},
+        {{a.x(), a.y(), a.z()}, {b.x(), a.y(), a.z()}, {b.x(), a.y(), b.z()}, {a.x(), a.y(), b.z()}, {0, -1, 0}},
+    };
+    float textureCoordinates[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    int corners[] = {0, 1, 2, 0, 2, 3};
+
+    QVector<float> vertices;
+    for (const auto &face : faces) {
+        for (int corner : corners) {
+            vertices << face[corner].x() << face[corner].y() << face[corner].z()
+                     << face[4].x() << face[4].y() << face[4].z()
+                     << textureCoordinates[corner][0] << textureCoordinates[corner][1];
+        }
+    }
+    return vertices;
+}
+
+void GridRenderer::loadTexture(const QImage &image, GLuint &texture)
+{
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // Most boards are small, without mipmaps the textures would shimmer.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width(), image.height(),
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+void GridRenderer::resize(int width, int height)
+{
+    this->width = qMax(1, width);
+    this->height = qMax(1, height);
+}
+
+void GridRenderer::setCamera(QVector2D centre, float zoom)
+{
+    this->centre = centre;
+    this->zoom = qMax(zoom, 0.1f);
+}
+
+void GridRenderer::updateCamera(int boardCount)
+{
+    columns = qMax(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(boardCount)))));
+    rows = qMax(1, (boardCount + columns - 1) / columns);
+
+    float aspectRatio = static_cast<float>(width) / height;
+    float tangent = std::tan(qDegreesToRadians(FieldOfView / 2));
+    float wallWidth = columns * pitch.x();
+    float wallHeight = rows * pitch.y();
+    float distance = qMax(wallHeight, wallWidth / aspectRatio) / 2 / tangent * Margin / zoom;
+
+    eye = QVector3D(centre, distance);
+    projectionTransform.setToIdentity();
+    projectionTransform.perspective(FieldOfView, aspectRatio, distance / 4, distance * 4);
+    projectionTransform.lookAt(eye, QVector3D(centre, 0), QVector3D(0, 1, 0));
+    pixelsPerUnit = height / (2 * tangent);
+
+    // The planes of the view frustum, pointing inwards.
+    QVector4D x = projectionTransform.row(0), y = projectionTransform.row(1);
+    QVector4D z = projectionTransform.row(2), w = projectionTransform.row(3);
+    frustum[0] = w + x;
+    frustum[1] = w - x;
+    frustum[2] = w + y;
+    frustum[3] = w - y;
+    frustum[4] = w + z;
+    frustum[5] = w - z;
+}
+
+bool GridRenderer::inView(QVector3D centre, float radius) const
+{
+    for (const QVector4D &plane : frustum) {
+        QVector3D normal = plane.toVector3D();
+        if (QVector3D::dotProduct(normal, centre) + plane.w() < -radius * normal.length()) return false;
+    }
+    return true;
+}
+
+static void appendTransform(std::vector<float> &transforms, const float *transform, QVector3D translation)
+{
+    transforms.insert(transforms.end(), transform, transform + 12);
+    transforms.push_back(translation.x());
+    transforms.push_back(translation.y());
+    transforms.push_back(translation.z());
+    transforms.push_back(1);
+}
+
+void GridRenderer::packBoard(const SceneState &scene, QVector3D origin, bool lowDetail)
+{
+    int colour;
+    switch (scene.gameWinner) {
+        case 'y': colour = 1; break;
+        case 'r': colour = 2; break;
+        case 'd': colour = 3; break;
+        default:  colour = 0; break;
+    }
+    float board[12] = {boardScale.x(), 0, 0, 0,
+                       0, boardScale.y(), 0, 0,
+                       0, 0, boardScale.z(), 0};
+    appendTransform(batches[(lowDetail ? BOX_BLUE : BOARD_BLUE) + colour].transforms, board, origin);
+
+    // A box has no holes, its disks are on its front. Falling disks stay
+    // in their own tile, they show up at the top of the board.
+    float depth = lowDetail ? boardMaximum.z() : 0;
+    float top = boardMaximum.y();
+    for (int i = 0; i < scene.diskCount; i++) {
+        const Disk &disk = scene.disks[i];
+        float height = disk.landed ? 0 : disk.heightAt(scene.interpolation);
+        QVector3D position(disk.x, qMin(disk.y + height, top), depth);
+        appendTransform(batches[disk.yellowDisk ? DISK_YELLOW : DISK_RED].transforms,
+                        diskTransform.constData(), origin + position);
+    }
+}
+
+void GridRenderer::render(const BoardWall &wall)
+{
+    frameProfiler.beginFrame();
+    frameStatistics = Statistics();
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+
+    {
+        ProfileScope scope(frameProfiler, FrameProfiler::TRANSFORMS);
+        updateCamera(wall.boardCount());
+
+        // The capacity is kept, after the first frames this does not allocate.
+        for (Batch &batch : batches) {
+            batch.transforms.clear();
+        }
+
+        float boardHeight = boardMaximum.y() - boardMinimum.y();
+        for (int i = 0; i < wall.boardCount(); i++) {
+            QVector3D origin(((i % columns) - (columns - 1) / 2.0f) * pitch.x(),
+                             ((rows - 1) / 2.0f - (i / columns)) * pitch.y(), 0);
+            if (!inView(origin, boardRadius)) continue;
+
+            float pixels = boardHeight * pixelsPerUnit / (origin - eye).length();
+            bool lowDetail = pixels < LowDetailPixels;
+            packBoard(wall.scene(i), origin, lowDetail);
+
+            frameStatistics.visibleBoards++;
+            if (lowDetail) frameStatistics.lowDetailBoards++;
+        }
+        frameStatistics.disks = static_cast<int>(batches[DISK_YELLOW].transforms.size() + batches[DISK_RED].transforms.size()) / 16;
+    }
+
+    frameProfiler.begin(FrameProfiler::CLEAR);
+    glClearColor(0.2f, 0.5f, 0.7f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    frameProfiler.end(FrameProfiler::CLEAR);
+
+    // One upload for every instance of the frame. The buffer is orphaned
+    // first, so the driver does not wait for the frame that still reads it.
+    size_t floats = 0;
+    for (const Batch &batch : batches) {
+        floats += batch.transforms.size();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, floats * sizeof(float), nullptr, GL_STREAM_DRAW);
+    GLintptr offsets[BatchCount];
+    GLintptr offset = 0;
+    for (int i = 0; i < BatchCount; i++) {
+        offsets[i] = offset;
+        GLsizeiptr bytes = batches[i].transforms.size() * sizeof(float);
+        if (bytes > 0) glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, batches[i].transforms.data());
+        offset += bytes;
+    }
+
+    shader->program.bind();
+    glUniformMatrix4fv(shader->projectionTransform, 1, GL_FALSE, projectionTransform.constData());
+    glUniform4fv(shader->material, 1, &material[0]);
+    glUniform3fv(shader->lightPosition, 1, &lightPosition[0]);
+    glUniform3fv(shader->lightColour, 1, &lightColour[0]);
+    glUniform1i(shader->texture1Sampler, 0);
+
+    frameProfiler.begin(FrameProfiler::BOARD);
+    for (int i = BOARD_BLUE; i <= BOX_GREY; i++) {
+        drawBatch(batches[i], offsets[i]);
+    }
+    frameProfiler.end(FrameProfiler::BOARD);
+
+    frameProfiler.begin(FrameProfiler::DISKS);
+    drawBatch(batches[DISK_YELLOW], offsets[DISK_YELLOW]);
+    drawBatch(batches[DISK_RED], offsets[DISK_RED]);
+    frameProfiler.end(FrameProfiler::DISKS);
+
+    shader->program.release();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    frameProfiler.endFrame();
+}
+
+void GridRenderer::drawBatch(Batch &batch, GLintptr offset)
+{
+    GLsizei instances = static_cast<GLsizei>(batch.transforms.size() / 16);
+    if (instances == 0) return;
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, batch.texture);
+    glBindVertexArray(batch.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float),
+                              (void *)(offset + column * 4 * sizeof(float)));
+    }
+    glDrawArraysInstanced(GL_TRIANGLES, 0, batch.size, instances);
+    frameStatistics.drawCalls++;
+}
@@ -0,0 +1,123 @@
+#ifndef GRIDRENDERER_H
+#define GRIDRENDERER_H
+
+#include "boardwall.h"
+#include "frameprofiler.h"
+#include "shadervariants.h"
+
+#include <QImage>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QMatrix4x4>
+#include <QVector2D>
+#include <QVector3D>
+#include <QVector4D>
+#include <vector>
+
+/**
+ * @brief The GridRenderer class
+ *
+ * Draws every board of a BoardWall in a grid, with a handful of instanced
+ * draw calls whatever the number of boards. Every frame the boards in
+ * view are packed into one instance buffer, a model transform per board
+ * and per disk, grouped by mesh and texture, and each group is one
+ * glDrawArraysInstanced with the instanced shader variant.
+ *
+ * Boards outside the view are culled. Boards smaller on the screen than
+ * LowDetailPixels are drawn as a box with the disks on its front instead
+ * of the board mesh, which has a thousand times as many triangles.
+ * All functions have to be called with the OpenGL context current.
+ */
+class GridRenderer : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    static const int LowDetailPixels = 96;
+
+    struct Statistics
+    {
+        int visibleBoards = 0;
+        int lowDetailBoards = 0;
+        int disks = 0;
+        int drawCalls = 0;
+    };
+
+    void initialize();
+    void destroy();
+
+    void resize(int width, int height);
+    // Looks at centre, in units of the wall, zoom 1 shows the whole wall.
+    void setCamera(QVector2D centre, float zoom);
+    QVector2D cameraCentre() const { return centre; }
+    float cameraZoom() const { return zoom; }
+    // Units of the wall per pixel, where the boards are, in the last frame.
+    float unitsPerPixel() const { return eye.z() / pixelsPerUnit; }
+
+    void render(const BoardWall &wall);
+
+    // Of the last frame.
+    const Statistics &statistics() const { return frameStatistics; }
+    FrameProfiler &profiler() { return frameProfiler; }
+
+private:
+    // A group of instances that share a mesh and a texture.
+    struct Batch
+    {
+        GLuint VAO = 0;
+        GLuint size = 0;
+        GLuint texture = 0;
+        std::vector<float> transforms; // 16 floats per instance
+    };
+
+    enum BatchIndex
+    {
+        BOARD_BLUE = 0, BOARD_YELLOW, BOARD_RED, BOARD_GREY,
+        BOX_BLUE, BOX_YELLOW, BOX_RED, BOX_GREY,
+        DISK_YELLOW, DISK_RED,
+        BatchCount
+    };
+
+    void loadMesh(const QVector<float> &vertices, GLuint &VAO, GLuint &VBO, GLuint &size);
+    QVector<float> boxVertices() const;
+    void loadTexture(const QImage &image, GLuint &texture);
+
+    void updateCamera(int boardCount);
+    bool inView(QVector3D centre, float radius) const;
+    void packBoard(const SceneState &scene, QVector3D origin, bool lowDetail);
+    void drawBatch(Batch &batch, GLintptr offset);
+
+    ShaderVariants shaders;
+    ShaderVariant *shader = nullptr;
+
+    GLuint boardVAO, boxVAO, diskVAO;
+    GLuint boardVBO, boxVBO, diskVBO;
+    GLuint boardSize, boxSize, diskSize;
+    GLuint instanceVBO;
+    GLuint blueTexture, yellowTexture, redTexture, greyTexture, yellowDiskTexture, redDiskTexture;
+
+    // Bounds of the board in the model and in the wall, and the distance between two boards.
+    QVector3D modelMinimum, modelMaximum;
+    QVector3D boardScale, boardMinimum, boardMaximum;
+    QVector2D pitch;
+    float boardRadius = 1;
+    QMatrix4x4 diskTransform;
+
+    Batch batches[BatchCount];
+
+    int width = 1, height = 1;
+    QVector2D centre;
+    float zoom = 1;
+    QMatrix4x4 projectionTransform;
+    QVector3D eye;
+    QVector4D frustum[6];
+    // Pixels per unit at a distance of one unit from the camera.
+    float pixelsPerUnit = 1;
+    int columns = 1, rows = 1;
+
+    QVector4D material = {0.5, 0.5, 1, 5};
+    QVector3D lightPosition = {1, 100, 1};
+    QVector3D lightColour = {1, 1, 1};
+
+    Statistics frameStatistics;
+    FrameProfiler frameProfiler;
+};
+
+#endif // GRIDRENDERER_H
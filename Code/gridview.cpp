@@ -0,0 +1,105 @@
+#include "gridview.h"
+
+#include <QPainter>
+#include <QtMath>
+
+GridView::GridView(int boardCount, QWidget *parent)
+    : QOpenGLWidget(parent), wall(boardCount)
+{
+    connect(&timer, SIGNAL(timeout()), this, SLOT(update()));
+    setFocusPolicy(Qt::StrongFocus);
+}
+
+GridView::~GridView()
+{
+    if (!isValid()) return;
+
+    makeCurrent();
+    renderer.destroy();
+    doneCurrent();
+}
+
+void GridView::initializeGL()
+{
+    renderer.initialize();
+    timer.start(1000.0 / 60.0);
+}
+
+void GridView::resizeGL(int newWidth, int newHeight)
+{
+    renderer.resize(newWidth * devicePixelRatio(), newHeight * devicePixelRatio());
+}
+
+void GridView::paintGL()
+{
+    qint64 nanoseconds = animationClock.isValid() ? animationClock.nsecsElapsed() : 0;
+    animationClock.start();
+    wall.advance(nanoseconds / 1e9);
+
+    renderer.render(wall);
+
+    if (renderer.profiler().isEnabled()) {
+        const GridRenderer::Statistics &statistics = renderer.statistics();
+        QString text = QString("%1 boards, %2 in view, %3 low detail\n%4 disks, %5 draw calls\n\n")
+                .arg(wall.boardCount()).arg(statistics.visibleBoards).arg(statistics.lowDetailBoards)
+                .arg(statistics.disks).arg(statistics.drawCalls);
+        QPainter painter(this);
+        painter.setPen(Qt::white);
+        painter.setFont(QFont("Monospace", 9));
+        painter.drawText(rect().adjusted(10, 10, -10, -10), Qt::AlignLeft | Qt::AlignTop,
+                         text + renderer.profiler().overlayText());
+    }
+}
+
+float GridView::unitsPerPixel() const
+{
+    return renderer.unitsPerPixel() * devicePixelRatio();
+}
+
+void GridView::keyPressEvent(QKeyEvent *ev)
+{
+    switch (ev->key()) {
+        case Qt::Key_Home:
+        case '0':
+            renderer.setCamera(QVector2D(), 1);
+            break;
+        case 'P':
+            renderer.profiler().setEnabled(!renderer.profiler().isEnabled());
+            break;
+        default:
+            QOpenGLWidget::keyPressEvent(ev);
+            return;
+    }
+    update();
+}
+
+void GridView::mousePressEvent(QMouseEvent *ev)
+{
+    lastPosition = ev->pos();
+}
+
+void GridView::mouseMoveEvent(QMouseEvent *ev)
+{
+    if (!(ev->buttons() & Qt::LeftButton)) return;
+
+    // The wall follows the mouse.
+    QPoint moved = ev->pos() - lastPosition;
+    lastPosition = ev->pos();
+    float units = unitsPerPixel();
+    renderer.setCamera(renderer.cameraCentre() + QVector2D(-moved.x(), moved.y()) * units,
+                       renderer.cameraZoom());
+    update();
+}
+
+void GridView::wheelEvent(QWheelEvent *ev)
+{
+    // The point under the mouse stays where it is.
+    QPointF fromCentre = ev->posF() - QPointF(width() / 2.0, height() / 2.0);
+    QVector2D point = renderer.cameraCentre() + QVector2D(fromCentre.x(), -fromCentre.y()) * unitsPerPixel();
+
+    float zoom = renderer.cameraZoom() * qPow(1.2, ev->angleDelta().y() / 120.0);
+    zoom = qBound(0.5f, zoom, 64.0f);
+    float scale = renderer.cameraZoom() / zoom;
+    renderer.setCamera(point + (renderer.cameraCentre() - point) * scale, zoom);
+    update();
+}
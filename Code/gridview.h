@@ -0,0 +1,49 @@
+#ifndef GRIDVIEW_H
+#define GRIDVIEW_H
+
+#include "boardwall.h"
+#include "gridrenderer.h"
+
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QOpenGLWidget>
+#include <QTimer>
+
+/**
+ * @brief The GridView class
+ *
+ * Shows a wall of games played by computer players. The wheel zooms in
+ * on the point under the mouse, dragging moves the camera, Home resets
+ * it and P shows the profiler overlay with the draw statistics.
+ */
+class GridView : public QOpenGLWidget
+{
+    Q_OBJECT
+
+public:
+    explicit GridView(int boardCount, QWidget *parent = 0);
+    ~GridView();
+
+protected:
+    void initializeGL();
+    void resizeGL(int newWidth, int newHeight);
+    void paintGL();
+
+    void keyPressEvent(QKeyEvent *ev);
+    void mouseMoveEvent(QMouseEvent *ev);
+    void mousePressEvent(QMouseEvent *ev);
+    void wheelEvent(QWheelEvent *ev);
+
+private:
+    // Units of the wall per pixel of the widget, at the current zoom.
+    float unitsPerPixel() const;
+
+    BoardWall wall;
+    GridRenderer renderer;
+    QTimer timer;
+    QElapsedTimer animationClock;
+    QPoint lastPosition;
+};
+
+#endif // GRIDVIEW_H
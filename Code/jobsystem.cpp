@@ -0,0 +1,394 @@
+#include "jobsystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Jobs a worker can queue before it runs the jobs it creates itself.
+static const int DequeCapacity = 4096;
+// Times an idle worker looks for a job before it goes to sleep.
+static const int IdleSpins = 64;
+
+namespace {
+
+std::int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The worker this thread is, of which job system.
+thread_local const JobSystem *threadSystem = nullptr;
+thread_local int threadWorker = -1;
+
+std::atomic<JobSystem *> applicationSystem(nullptr);
+
+}
+
+class JobSystem::Job
+{
+public:
+    const char *name;
+    Function function;
+    // Dependencies that have not finished, plus one until the job is submitted.
+    std::atomic<int> blockers;
+    std::atomic<bool> finished;
+
+    // Guards dependents, and finished while dependents are added.
+    std::mutex mutex;
+    std::vector<JobHandle> dependents;
+    // Keeps the job alive while it is queued.
+    JobHandle self;
+
+    Job(const char *name, Function function)
+        : name(name), function(std::move(function)), blockers(1), finished(false)
+    {    }
+};
+
+/**
+ * The deque of Chase and Lev, with the memory orders of Lê et al., "Correct
+ * and Efficient Work-Stealing for Weak Memory Models". Only the owner
+ * pushes and pops at the bottom, any thread steals from the top.
+ */
+class JobSystem::Deque
+{
+public:
+    Deque() : top(0), bottom(0), jobs(DequeCapacity)
+    {
+        for (std::atomic<Job *> &job : jobs) job.store(nullptr, std::memory_order_relaxed);
+    }
+
+    // False if the deque is full.
+    bool push(Job *job)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= DequeCapacity) return false;
+
+        jobs[b % DequeCapacity].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job *pop()
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job *job = jobs[b % DequeCapacity].load(std::memory_order_relaxed);
+        if (t == b) {
+            // The last job, a thief may be taking it as well.
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job *steal()
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Job *job = jobs[t % DequeCapacity].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+private:
+    // On cache lines of their own, the owner writes bottom and the thieves top.
+    std::atomic<std::int64_t> top;
+    char padding[64 - sizeof(std::atomic<std::int64_t>)];
+    std::atomic<std::int64_t> bottom;
+    std::vector<std::atomic<Job *>> jobs;
+};
+
+struct JobSystem::Worker
+{
+    Deque deque;
+    std::thread thread;
+    std::atomic<std::int64_t> jobs{0};
+    std::atomic<std::int64_t> steals{0};
+    unsigned random = 0;
+};
+
+// A part of a parallelFor.
+struct JobSystem::Range
+{
+    const char *name;
+    int grain;
+    const std::function<void(int, int)> *function;
+    std::atomic<int> *remaining;
+};
+
+JobSystem::JobSystem(int threads)
+    : JobSystem(threads, true)
+{
+}
+
+JobSystem::JobSystem(int threads, bool application)
+    : queued(0), sleeping(0), externalJobs(0), startTime(now())
+{
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < threads - 1; i++) {
+        workers.emplace_back(new Worker);
+        workers.back()->random = 2654435761u * (i + 1);
+    }
+    for (int i = 0; i < threads - 1; i++) {
+        workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+
+    JobSystem *none = nullptr;
+    if (application) applicationSystem.compare_exchange_strong(none, this);
+}
+
+JobSystem::~JobSystem()
+{
+    JobSystem *self = this;
+    applicationSystem.compare_exchange_strong(self, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::unique_ptr<Worker> &worker : workers) {
+        worker->thread.join();
+    }
+}
+
+JobSystem &JobSystem::instance()
+{
+    JobSystem *system = applicationSystem.load();
+    if (system) return *system;
+
+    static JobSystem serial(1, false);
+    return serial;
+}
+
+JobSystem::JobHandle JobSystem::create(const char *name, Function function)
+{
+    return std::make_shared<Job>(name, std::move(function));
+}
+
+void JobSystem::addDependency(const JobHandle &job, const JobHandle &dependency)
+{
+    std::lock_guard<std::mutex> lock(dependency->mutex);
+    if (dependency->finished.load(std::memory_order_relaxed)) return;
+
+    job->blockers.fetch_add(1, std::memory_order_relaxed);
+    dependency->dependents.push_back(job);
+}
+
+void JobSystem::submit(const JobHandle &job)
+{
+    if (job->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        job->self = job;
+        schedule(job.get());
+    }
+}
+
+JobSystem::JobHandle JobSystem::run(const char *name, Function function)
+{
+    JobHandle job = create(name, std::move(function));
+    submit(job);
+    return job;
+}
+
+bool JobSystem::isFinished(const JobHandle &job) const
+{
+    return job->finished.load(std::memory_order_acquire);
+}
+
+void JobSystem::wait(const JobHandle &job)
+{
+    runUntil([&job]() { return job->finished.load(std::memory_order_acquire); });
+}
+
+JobSystem::Statistics JobSystem::statistics() const
+{
+    Statistics statistics;
+    statistics.jobs = externalJobs.load(std::memory_order_relaxed);
+    for (const std::unique_ptr<Worker> &worker : workers) {
+        statistics.jobs += worker->jobs.load(std::memory_order_relaxed);
+        statistics.steals += worker->steals.load(std::memory_order_relaxed);
+    }
+    return statistics;
+}
+
+int JobSystem::currentWorker() const
+{
+    return threadSystem == this ? threadWorker : -1;
+}
+
+void JobSystem::schedule(Job *job)
+{
+    int worker = currentWorker();
+    if (worker >= 0) {
+        if (!workers[worker]->deque.push(job)) {
+            // Full, so there is plenty to steal already.
+            execute(job);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        sharedQueue.push_back(job);
+    }
+
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+JobSystem::Job *JobSystem::take()
+{
+    int worker = currentWorker();
+    if (worker >= 0) {
+        if (Job *job = workers[worker]->deque.pop()) return job;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (sharedFront < sharedQueue.size()) {
+            Job *job = sharedQueue[sharedFront++];
+            if (sharedFront == sharedQueue.size()) {
+                sharedQueue.clear();
+                sharedFront = 0;
+            }
+            return job;
+        }
+    }
+
+    // Steal, starting at a random victim so thieves spread out.
+    int count = static_cast<int>(workers.size());
+    if (count == 0) return nullptr;
+    unsigned random = worker >= 0 ? (workers[worker]->random = workers[worker]->random * 1664525u + 1013904223u)
+                                  : static_cast<unsigned>(now());
+    int first = static_cast<int>((random >> 16) % count);
+    for (int i = 0; i < count; i++) {
+        int victim = (first + i) % count;
+        if (victim == worker) continue;
+        if (Job *job = workers[victim]->deque.steal()) {
+            if (worker >= 0) workers[worker]->steals.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool JobSystem::runOne()
+{
+    Job *job = take();
+    if (!job) return false;
+
+    queued.fetch_sub(1);
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(Job *job)
+{
+    int worker = currentWorker();
+    if (traceHook) {
+        TraceEvent event = {job->name, worker, now() - startTime, 0};
+        job->function();
+        event.end = now() - startTime;
+        traceHook(event);
+    } else {
+        job->function();
+    }
+    // Frees what the function holds on to.
+    job->function = nullptr;
+
+    if (worker >= 0) {
+        workers[worker]->jobs.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        externalJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished.store(true, std::memory_order_release);
+        dependents.swap(job->dependents);
+    }
+    for (JobHandle &dependent : dependents) {
+        submit(dependent);
+    }
+
+    // The job may be gone after this.
+    JobHandle self = std::move(job->self);
+}
+
+template <typename Condition>
+void JobSystem::runUntil(const Condition &done)
+{
+    while (!done()) {
+        if (!runOne()) std::this_thread::yield();
+    }
+}
+
+void JobSystem::workerLoop(int index)
+{
+    threadSystem = this;
+    threadWorker = index;
+
+    for (;;) {
+        bool ran = false;
+        for (int spin = 0; spin < IdleSpins && !ran; spin++) {
+            ran = runOne();
+            if (!ran) std::this_thread::yield();
+        }
+        if (ran) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        wake.wait(lock, [this]() { return queued.load() > 0 || stopping; });
+        sleeping.fetch_sub(1);
+        if (stopping && queued.load() <= 0) return;
+    }
+}
+
+void JobSystem::parallelForRanges(const char *name, int begin, int end, int grain,
+                                  const std::function<void(int, int)> &function)
+{
+    if (begin >= end) return;
+    if (workers.empty()) {
+        function(begin, end);
+        return;
+    }
+
+    std::atomic<int> remaining(end - begin);
+    Range range = {name, std::max(grain, 1), &function, &remaining};
+    run(name, [this, range, begin, end]() { splitRange(range, begin, end); });
+    runUntil([&remaining]() { return remaining.load(std::memory_order_acquire) == 0; });
+}
+
+void JobSystem::splitRange(const Range &range, int begin, int end)
+{
+    // The far halves go to the deque, where thieves take the largest first.
+    while (end - begin > range.grain) {
+        int middle = begin + (end - begin) / 2;
+        Range half = range;
+        run(range.name, [this, half, middle, end]() { splitRange(half, middle, end); });
+        end = middle;
+    }
+    (*range.function)(begin, end);
+    // The last use of range, parallelFor may return after it.
+    range.remaining->fetch_sub(end - begin, std::memory_order_acq_rel);
+}
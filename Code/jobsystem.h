@@ -0,0 +1,135 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The JobSystem class
+ *
+ * The threads of the application, shared by everything that has work to
+ * split up: loading models, decoding textures and searching for moves.
+ * Every worker has a deque of jobs. A job that a worker creates goes on
+ * the bottom of its own deque, and the worker takes its next job from the
+ * bottom as well, so it works depth first and on data that is still in its
+ * cache. An idle worker steals from the top of another worker's deque,
+ * which holds the oldest and so the largest pieces of work. Threads that
+ * are not workers hand their jobs over through a shared queue.
+ *
+ * A job runs once all jobs it depends on have finished. A thread that
+ * waits for a job runs other jobs in the meantime, so jobs may wait for
+ * jobs they start without tying up a thread. Jobs must not throw.
+ *
+ * The application creates one, which makes it the instance(); without
+ * one, instance() runs every job on the thread that waits for it. Does not
+ * depend on Qt, like the rest of engine.pri.
+ */
+class JobSystem
+{
+public:
+    class Job;
+    typedef std::shared_ptr<Job> JobHandle;
+    typedef std::function<void()> Function;
+
+    // A job that ran, for the trace hook.
+    struct TraceEvent
+    {
+        const char *name;
+        int thread; // The worker, or -1 for a thread that waited
+        std::int64_t start, end; // Nanoseconds since the job system was created
+    };
+    typedef std::function<void(const TraceEvent &)> TraceHook;
+
+    struct Statistics
+    {
+        std::int64_t jobs = 0;
+        std::int64_t steals = 0;
+    };
+
+    // Threads that run jobs, including the thread that waits for them, so
+    // 1 starts no workers at all. 0 uses one per core.
+    explicit JobSystem(int threads = 0);
+    // All jobs have to be finished.
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    int threadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // A job that does not run before it is submitted. name has to be a
+    // string literal, or live as long as the job system.
+    JobHandle create(const char *name, Function function);
+    // job runs after dependency has finished. Only before job is submitted.
+    void addDependency(const JobHandle &job, const JobHandle &dependency);
+    void submit(const JobHandle &job);
+    JobHandle run(const char *name, Function function);
+
+    bool isFinished(const JobHandle &job) const;
+    // Runs jobs until job has finished.
+    void wait(const JobHandle &job);
+
+    // Calls function(i) for every i from begin to end, in jobs of at most
+    // grain indices, and returns when all of them are done.
+    template <typename IndexFunction>
+    void parallelFor(const char *name, int begin, int end, int grain, const IndexFunction &function)
+    {
+        parallelForRanges(name, begin, end, grain, [&function](int first, int last) {
+            for (int i = first; i < last; i++) function(i);
+        });
+    }
+
+    // Called on the thread that ran the job, after every job. Only set it
+    // while no jobs run.
+    void setTraceHook(TraceHook hook) { traceHook = std::move(hook); }
+    Statistics statistics() const;
+
+    // The job system of the application, or one without workers.
+    static JobSystem &instance();
+
+private:
+    class Deque;
+    struct Worker;
+    struct Range;
+
+    JobSystem(int threads, bool application);
+
+    void parallelForRanges(const char *name, int begin, int end, int grain,
+                           const std::function<void(int, int)> &function);
+    void splitRange(const Range &range, int begin, int end);
+
+    void schedule(Job *job);
+    Job *take();
+    bool runOne();
+    void execute(Job *job);
+    template <typename Condition>
+    void runUntil(const Condition &done);
+    void workerLoop(int index);
+    int currentWorker() const;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Jobs from threads that are not workers.
+    std::mutex sharedMutex;
+    std::vector<Job *> sharedQueue;
+    std::size_t sharedFront = 0;
+
+    // Queued jobs, so idle workers know when to sleep.
+    std::atomic<int> queued;
+    std::atomic<int> sleeping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::atomic<std::int64_t> externalJobs;
+    std::int64_t startTime;
+    TraceHook traceHook;
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,145 @@
+#include "latencytracker.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+LatencyTracker::LatencyTracker()
+{
+    clock.start();
+    for (std::vector<qint64> &stage : history) {
+        stage.assign(HistorySize, -1);
+    }
+}
+
+const char *LatencyTracker::stageName(Stage stage)
+{
+    switch (stage) {
+        case STATE:  return "state";
+        case SUBMIT: return "submit";
+        case SWAP:   return "swap";
+        case TOTAL:  return "total";
+        default:     return "unknown";
+    }
+}
+
+void LatencyTracker::inputReceived()
+{
+    // Later inputs show up in the same frame as the first one.
+    if (progress != IDLE) return;
+
+    times[TOTAL] = clock.nsecsElapsed();
+    progress = RECEIVED;
+}
+
+void LatencyTracker::stateChanged()
+{
+    if (progress != RECEIVED) return;
+
+    times[STATE] = clock.nsecsElapsed();
+    progress = CHANGED;
+}
+
+void LatencyTracker::frameSubmitted()
+{
+    if (progress == CHANGED) {
+        times[SUBMIT] = clock.nsecsElapsed();
+        progress = SUBMITTED;
+    } else if (progress == RECEIVED) {
+        // The input did not change anything that can be shown.
+        progress = IDLE;
+    }
+}
+
+void LatencyTracker::frameSwapped()
+{
+    if (progress != SUBMITTED) return;
+
+    times[SWAP] = clock.nsecsElapsed();
+    int slot = count % HistorySize;
+    history[STATE][slot] = times[STATE] - times[TOTAL];
+    history[SUBMIT][slot] = times[SUBMIT] - times[STATE];
+    history[SWAP][slot] = times[SWAP] - times[SUBMIT];
+    history[TOTAL][slot] = times[SWAP] - times[TOTAL];
+    count++;
+    progress = IDLE;
+}
+
+LatencyTracker::Statistics LatencyTracker::statistics(Stage stage) const
+{
+    std::vector<double> values;
+    values.reserve(HistorySize);
+    for (qint64 value : history[stage]) {
+        if (value >= 0) values.push_back(value / 1e6);
+    }
+
+    Statistics result;
+    if (values.empty()) return result;
+
+    std::sort(values.begin(), values.end());
+    int samples = static_cast<int>(values.size());
+    double sum = 0;
+    for (double value : values) sum += value;
+
+    result.samples = samples;
+    result.mean = sum / samples;
+    result.p50 = values[qMin(samples - 1, int(0.50 * samples))];
+    result.p95 = values[qMin(samples - 1, int(0.95 * samples))];
+    result.p99 = values[qMin(samples - 1, int(0.99 * samples))];
+    return result;
+}
+
+std::vector<int> LatencyTracker::histogram() const
+{
+    std::vector<int> buckets(HistogramBuckets, 0);
+    for (qint64 value : history[TOTAL]) {
+        if (value >= 0) buckets[qMin<qint64>(HistogramBuckets - 1, value / 1000000)]++;
+    }
+    return buckets;
+}
+
+QString LatencyTracker::overlayText() const
+{
+    QString text = QString("%1 ms          p50    p95    p99\n").arg("latency", -10);
+    for (int i = 0; i < StageCount; i++) {
+        Stage stage = static_cast<Stage>(i);
+        Statistics times = statistics(stage);
+        text += QString("%1      %2 %3 %4\n").arg(stageName(stage), -10)
+                .arg(times.p50, 6, 'f', 2).arg(times.p95, 6, 'f', 2).arg(times.p99, 6, 'f', 2);
+    }
+    return text;
+}
+
+bool LatencyTracker::writeSummary(const QString &fileName) const
+{
+    QJsonObject stages;
+    for (int i = 0; i < StageCount; i++) {
+        Stage stage = static_cast<Stage>(i);
+        Statistics times = statistics(stage);
+        QJsonObject object;
+        object["samples"] = times.samples;
+        object["mean"] = times.mean;
+        object["p50"] = times.p50;
+        object["p95"] = times.p95;
+        object["p99"] = times.p99;
+        stages[stageName(stage)] = object;
+    }
+
+    QJsonArray buckets;
+    for (int bucket : histogram()) {
+        buckets.append(bucket);
+    }
+
+    QJsonObject summary;
+    summary["inputs"] = count;
+    summary["unit"] = QString("ms");
+    summary["stages"] = stages;
+    summary["histogram"] = buckets;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return file.write(QJsonDocument(summary).toJson()) >= 0;
+}
@@ -0,0 +1,76 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief The LatencyTracker class
+ *
+ * Measures how long it takes from an input until the frame that shows it
+ * is swapped. Every input that changes the game is timed in stages:
+ * handling the input event until the game changed, until the frame with
+ * the change was drawn, and until that frame was swapped. The time of an
+ * input is when its event is handled, because Qt's event timestamps come
+ * from the window system and are on a different clock.
+ *
+ * Inputs that come before the frame of an earlier input are measured
+ * from the earliest of them. The last HistorySize measurements are kept
+ * for percentiles and a histogram of the total latency.
+ */
+class LatencyTracker
+{
+public:
+    enum Stage
+    {
+        STATE = 0, // The input event until the game changed
+        SUBMIT,    // Until the frame with the change was drawn
+        SWAP,      // Until that frame was swapped
+        TOTAL,
+        StageCount
+    };
+
+    static const int HistorySize = 512;
+    // The histogram has buckets of a millisecond, the last one holds everything slower.
+    static const int HistogramBuckets = 100;
+
+    struct Statistics
+    {
+        int samples = 0;
+        double mean = 0, p50 = 0, p95 = 0, p99 = 0; // Milliseconds
+    };
+
+    LatencyTracker();
+
+    static const char *stageName(Stage stage);
+
+    void inputReceived();
+    void stateChanged();
+    void frameSubmitted();
+    void frameSwapped();
+
+    Statistics statistics(Stage stage) const;
+    // Inputs per millisecond of total latency.
+    std::vector<int> histogram() const;
+
+    // A few lines with the percentiles of every stage.
+    QString overlayText() const;
+    // Percentiles of every stage and the histogram as JSON.
+    bool writeSummary(const QString &fileName) const;
+
+private:
+    enum Progress
+    {
+        IDLE, RECEIVED, CHANGED, SUBMITTED
+    };
+
+    QElapsedTimer clock;
+    Progress progress = IDLE;
+    qint64 times[StageCount]; // Nanoseconds since the construction
+
+    qint64 count = 0;
+    std::vector<qint64> history[StageCount];
+};
+
+#endif // LATENCYTRACKER_H
@@ -0,0 +1,237 @@
+#include "lightbaker.h"
+#include "eventlog.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cmath>
+#include <vector>
+
+// Cells along the longest side of the mesh.
+static const int GridSize = 64;
+// Rays per vertex for the ambient occlusion, and how far they look in cells.
+static const int AmbientRays = 32;
+static const float AmbientDistance = 12;
+// Rays start this many cells away from the vertex, so the surface it lies on does not block them.
+static const float RayOffset = 2;
+// Vertices baked by one job.
+static const int BatchSize = 1024;
+// Part of the hash, change it when the baking changes so old results are not used.
+static const char BakeVersion[] = "bakedlight 1";
+
+namespace {
+
+// The cells of a grid around the mesh that its triangles pass through.
+class OccupancyGrid
+{
+public:
+    explicit OccupancyGrid(const QVector<float> &vertices);
+
+    float cellSize() const { return size; }
+
+    // True if a ray from the origin hits an occupied cell within the distance.
+    bool blocked(QVector3D origin, QVector3D direction, float distance) const;
+
+private:
+    // Index of the cell the point is in, -1 outside the grid.
+    int cell(QVector3D point) const;
+
+    QVector3D minimum, maximum;
+    float size = 1;
+    int dimensions[3] = {1, 1, 1};
+    std::vector<char> cells = std::vector<char>(1, 0);
+};
+
+QVector3D position(const float *vertex)
+{
+    return QVector3D(vertex[0], vertex[1], vertex[2]);
+}
+
+OccupancyGrid::OccupancyGrid(const QVector<float> &vertices)
+{
+    int vertexCount = vertices.size() / LightBaker::VertexStride;
+    if (vertexCount == 0) return;
+
+    minimum = maximum = position(vertices.constData());
+    for (int i = 1; i < vertexCount; i++) {
+        QVector3D point = position(vertices.constData() + i * LightBaker::VertexStride);
+        for (int axis = 0; axis < 3; axis++) {
+            minimum[axis] = qMin(minimum[axis], point[axis]);
+            maximum[axis] = qMax(maximum[axis], point[axis]);
+        }
+    }
+
+    QVector3D extent = maximum - minimum;
+    size = qMax(qMax(extent.x(), extent.y()), qMax(extent.z(), 1e-6f)) / GridSize;
+    for (int axis = 0; axis < 3; axis++) {
+        dimensions[axis] = static_cast<int>(extent[axis] / size) + 1;
+        maximum[axis] = minimum[axis] + dimensions[axis] * size;
+    }
+    cells.assign(dimensions[0] * dimensions[1] * dimensions[2], 0);
+
+    // Mark the cells of points on the triangles, less than half a cell apart.
+    for (int i = 0; i + 2 < vertexCount; i += 3) {
+        QVector3D a = position(vertices.constData() + i * LightBaker::VertexStride);
+        QVector3D b = position(vertices.constData() + (i + 1) * LightBaker::VertexStride);
+        QVector3D c = position(vertices.constData() + (i + 2) * LightBaker::VertexStride);
+
+        float longest = qMax(qMax((b - a).length(), (c - a).length()), (c - b).length());
+        int steps = qMax(1, static_cast<int>(std::ceil(longest / (size * 0.5f))));
+        for (int u = 0; u <= steps; u++) {
+            for (int v = 0; u + v <= steps; v++) {
+                int index = cell(a + (b - a) * (float(u) / steps) + (c - a) * (float(v) / steps));
+                if (index >= 0) cells[index] = 1;
+            }
+        }
+    }
+}
+
+int OccupancyGrid::cell(QVector3D point) const
+{
+    int index = 0;
+    for (int axis = 2; axis >= 0; axis--) {
+        int coordinate = static_cast<int>(std::floor((point[axis] - minimum[axis]) / size));
+        if (coordinate < 0 || coordinate >= dimensions[axis]) return -1;
+        index = index * dimensions[axis] + coordinate;
+    }
+    return index;
+}
+
+bool OccupancyGrid::blocked(QVector3D origin, QVector3D direction, float distance) const
+{
+    // Only march the part of the ray that is inside the grid.
+    float enter = 0, leave = distance;
+    for (int axis = 0; axis < 3; axis++) {
+        if (std::fabs(direction[axis]) < 1e-6f) {
+            if (origin[axis] < minimum[axis] || origin[axis] > maximum[axis]) return false;
+            continue;
+        }
+        float t1 = (minimum[axis] - origin[axis]) / direction[axis];
+        float t2 = (maximum[axis] - origin[axis]) / direction[axis];
+        enter = qMax(enter, qMin(t1, t2));
+        leave = qMin(leave, qMax(t1, t2));
+        if (enter > leave) return false;
+    }
+
+    for (float t = enter; t <= leave; t += size * 0.5f) {
+        int index = cell(origin + direction * t);
+        if (index >= 0 && cells[index]) return true;
+    }
+    return false;
+}
+
+// Cosine weighted directions around +z, spread with the golden angle.
+std::vector<QVector3D> hemisphereDirections()
+{
+    std::vector<QVector3D> directions;
+    for (int i = 0; i < AmbientRays; i++) {
+        float height = (i + 0.5f) / AmbientRays;
+        float radius = std::sqrt(height);
+        float angle = i * 2.3999632f;
+        directions.push_back(QVector3D(radius * std::cos(angle), radius * std::sin(angle), std::sqrt(1 - height)));
+    }
+    return directions;
+}
+
+void bakeVertex(const OccupancyGrid &grid, const std::vector<QVector3D> &directions, const float *vertex,
+                QVector3D lightPosition, QVector4D material, float *baked)
+{
+    QVector3D point = position(vertex);
+    QVector3D normal = QVector3D(vertex[3], vertex[4], vertex[5]).normalized();
+    QVector3D origin = point + normal * (RayOffset * grid.cellSize());
+
+    // Turn the directions around +z to directions around the normal.
+    QVector3D tangent = QVector3D::crossProduct(std::fabs(normal.x()) > 0.9f ? QVector3D(0, 1, 0) : QVector3D(1, 0, 0), normal).normalized();
+    QVector3D bitangent = QVector3D::crossProduct(normal, tangent);
+
+    int open = 0;
+    for (const QVector3D &direction : directions) {
+        QVector3D ray = tangent * direction.x() + bitangent * direction.y() + normal * direction.z();
+        if (!grid.blocked(origin, ray, AmbientDistance * grid.cellSize())) open++;
+    }
+
+    QVector3D toLight = lightPosition - point;
+    float diffuse = qMax(QVector3D::dotProduct(normal, toLight.normalized()), 0.0f);
+    if (diffuse > 0 && grid.blocked(origin, toLight.normalized(), toLight.length())) {
+        diffuse = 0;
+    }
+
+    baked[0] = material.x() * open / AmbientRays;
+    baked[1] = material.y() * diffuse;
+}
+
+}
+
+LightBaker::Bake LightBaker::bake(const QVector<float> &vertices, QVector3D lightPosition, QVector4D material)
+{
+    Bake bake;
+    JobSystem &jobs = JobSystem::instance();
+    if (jobs.threadCount() == 1) {
+        // Nothing would run the job until someone waits for it.
+        *bake.baked = bakeNow(vertices, lightPosition, material);
+        return bake;
+    }
+
+    bake.jobs = &jobs;
+    std::shared_ptr<QVector<float>> baked = bake.baked;
+    bake.job = jobs.run("bake light", [baked, vertices, lightPosition, material]() {
+        *baked = bakeNow(vertices, lightPosition, material);
+    });
+    return bake;
+}
+
+QVector<float> LightBaker::bakeNow(const QVector<float> &vertices, QVector3D lightPosition, QVector4D material)
+{
+    int vertexCount = vertices.size() / VertexStride;
+    QVector<float> baked(vertexCount * BakedStride);
+    qint64 bytes = baked.size() * qint64(sizeof(float));
+
+    QString fileName = cacheFile(vertices, lightPosition, material);
+    QFile cached(fileName);
+    if (cached.open(QIODevice::ReadOnly) && cached.size() == bytes &&
+        cached.read(reinterpret_cast<char *>(baked.data()), bytes) == bytes) {
+        return baked;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    OccupancyGrid grid(vertices);
+    std::vector<QVector3D> directions = hemisphereDirections();
+
+    // Take the pointers here, the jobs must not detach the vectors.
+    const float *in = vertices.constData();
+    float *out = baked.data();
+    JobSystem::instance().parallelFor("bake vertices", 0, vertexCount, BatchSize, [&](int i) {
+        bakeVertex(grid, directions, in + i * VertexStride, lightPosition, material, out + i * BakedStride);
+    });
+
+    EventLog::info("Baked the light of %d vertices in %lld ms", vertexCount, timer.elapsed());
+
+    // Written to a temporary file first, other processes may read the cache.
+    QDir().mkpath(QFileInfo(fileName).path());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(reinterpret_cast<const char *>(baked.constData()), bytes) != bytes || !file.commit()) {
+        EventLog::warning("Could not write the baked light to %s", qPrintable(fileName));
+    }
+    return baked;
+}
+
+QString LightBaker::cacheFile(const QVector<float> &vertices, QVector3D lightPosition, QVector4D material)
+{
+    float light[] = {lightPosition.x(), lightPosition.y(), lightPosition.z(),
+                     material.x(), material.y(), material.z(), material.w()};
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(BakeVersion, sizeof(BakeVersion));
+    hash.addData(reinterpret_cast<const char *>(vertices.constData()), vertices.size() * int(sizeof(float)));
+    hash.addData(reinterpret_cast<const char *>(light), int(sizeof(light)));
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/bakedlight/" +
+           QString::fromLatin1(hash.result().toHex()) + ".bin";
+}
@@ -0,0 +1,64 @@
+#ifndef LIGHTBAKER_H
+#define LIGHTBAKER_H
+
+#include "jobsystem.h"
+
+#include <QString>
+#include <QVector>
+#include <QVector3D>
+#include <QVector4D>
+
+/**
+ * @brief The LightBaker class
+ *
+ * Bakes the light on a mesh that does not move into two values per
+ * vertex: the ambient light, darkened by ambient occlusion, and the
+ * diffuse light, which is zero where the mesh shadows itself. Specular
+ * light depends on the camera and is not baked. The light position is in
+ * the coordinates of the mesh, as in the other shading modes.
+ *
+ * Occlusion is found by marching rays through a grid of the cells that
+ * the triangles of the mesh pass through. The vertices are split over the
+ * threads of the JobSystem, and the result is kept in the cache
+ * directory under a hash of the mesh and the light, so a mesh is only
+ * baked once.
+ */
+class LightBaker
+{
+public:
+    // Floats per vertex: position, normal and texture coordinates in, ambient and diffuse out.
+    static const int VertexStride = 8;
+    static const int BakedStride = 2;
+
+    // A bake that runs as a job. One that was never started is finished
+    // and has an empty result.
+    class Bake
+    {
+    public:
+        bool isFinished() const { return !job || jobs->isFinished(job); }
+        // Runs jobs until the bake is done.
+        void wait() { if (job) jobs->wait(job); }
+        // Only once it is finished.
+        const QVector<float> &result() const { return *baked; }
+
+    private:
+        friend class LightBaker;
+        JobSystem *jobs = nullptr;
+        JobSystem::JobHandle job;
+        std::shared_ptr<QVector<float>> baked = std::make_shared<QVector<float>>();
+    };
+
+    // Bakes the interleaved vertices in the background, on the JobSystem.
+    // Without workers it bakes them before it returns.
+    static Bake bake(const QVector<float> &vertices, QVector3D lightPosition, QVector4D material);
+
+    // Bakes the interleaved vertices before it returns.
+    static QVector<float> bakeNow(const QVector<float> &vertices,
+                                  QVector3D lightPosition, QVector4D material);
+
+private:
+    static QString cacheFile(const QVector<float> &vertices,
+                             QVector3D lightPosition, QVector4D material);
+};
+
+#endif // LIGHTBAKER_H
@@ -1,26 +1,195 @@
+#include "assetbundle.h"
+#include "eventlog.h"
+#include "gridview.h"
+#include "jobsystem.h"
 #include "mainwindow.h"
+#include "mainview.h"
+#include "softwareview.h"
+#include "startupprofile.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
 #include <QSurfaceFormat>
+#include <QTextStream>
 #include <ctime>
 
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
+    // Cheap enough to always run, it is only reported with --startup-profile.
+    StartupProfile startup;
+    startup.begin("application");
+
     std::srand(std::time(nullptr));
+
+    // The shader cache has to be turned off before the application starts.
+    for (int i = 1; i < argc; i++) {
+        if (qstrcmp(argv[i], "--no-shader-cache") == 0) {
+            QCoreApplication::setAttribute(Qt::AA_DisableShaderDiskCache);
+        }
+    }
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOptions({
+        {"record", "Write every game played to this game record archive.", "file"},
+        {"capture", "F9 starts and stops recording the frames to this Y4M video, or to this directory as PNGs if it does not end in .y4m.", "file", "capture.y4m"},
+        {"no-shader-cache", "Build the shader programs from source instead of loading them from the disk cache."},
+        {"shadows", "Shadows: off, uncached or cached.", "mode", "cached"},
+        {"frame-budget", "Lower the resolution of the scene to keep the GPU time of a frame under this many milliseconds.", "ms"},
+        {"low-latency", "Draw the frame of an input right away, without waiting for the vertical blank."},
+        {"render-thread", "Draw the game on a thread of its own, so the user interface never holds up a frame."},
+        {"software-renderer", "Draw the game on the CPU, without OpenGL."},
+        {"threads", "Parts the software renderer splits a frame into, one per thread of the job system by default.", "n", "0"},
+        {"incremental", "Draw the board and the table once, and after that only the disks."},
+        {"bounce", "Let the disks bounce when they land."},
+        {"grid", "Show this many games played by the computer at once, instead of a game to play.", "boards"},
+        {"profile", "Start with the frame profiler and its overlay enabled."},
+        {"diagnostics", "warning, info, debug for an OpenGL debug context with its messages logged asynchronously, or trace to log them synchronously.", "level", "info"},
+        {"log", "Write the event log to this file instead of standard error.", "file"},
+        {"assets", "Asset bundle to load the models, textures and shaders from, instead of assets.bundle next to the program.", "file"},
+        {"jobs", "Threads of the job system that loads the assets and searches for moves, one per core by default.", "n", "0"},
+        {"startup-profile", "Print how long every phase of the start up took as JSON, after the first frame."},
+        {"startup-baseline", "Quit after the first frame, with an error if a phase of the start up was slower than in this report.", "file"},
+        {"startup-threshold", "Factor a phase may be slower than in the baseline.", "factor", "1.5"},
+    });
+    parser.process(a);
+
+    QTextStream err(stderr);
+    if (!checkInteger(parser, "jobs", 0, err) || !checkInteger(parser, "threads", 0, err) ||
+        (parser.isSet("grid") && !checkInteger(parser, "grid", 1, err))) {
+        return 1;
+    }
+
+    SceneRenderer::ShadowMode shadows;
+    if (parser.value("shadows") == "off") {
+        shadows = SceneRenderer::SHADOWS_OFF;
+    } else if (parser.value("shadows") == "uncached") {
+        shadows = SceneRenderer::SHADOWS_UNCACHED;
+    } else if (parser.value("shadows") == "cached") {
+        shadows = SceneRenderer::SHADOWS_CACHED;
+    } else {
+        err << "Unknown shadow mode: " << parser.value("shadows") << Qt::endl;
+        return 1;
+    }
+
+    float frameBudget = 0;
+    if (parser.isSet("frame-budget")) {
+        bool ok = false;
+        frameBudget = parser.value("frame-budget").toFloat(&ok);
+        if (!ok || !(frameBudget > 0)) {
+            err << "--frame-budget must be a number of milliseconds above 0, not " << parser.value("frame-budget") << Qt::endl;
+            return 1;
+        }
+    }
+
+    EventLog::Level diagnostics;
+    if (!EventLog::parseLevel(parser.value("diagnostics"), diagnostics)) {
+        QTextStream(stderr) << "Unknown diagnostics level: " << parser.value("diagnostics") << Qt::endl;
+        return 1;
+    }
+    EventLog::setLevel(diagnostics);
+    if (!EventLog::start(parser.value("log"))) {
+        QTextStream(stderr) << "Could not write the event log to " << parser.value("log") << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet("assets") && !AssetBundle::setShared(parser.value("assets"))) {
+        QTextStream(stderr) << "Could not open the asset bundle " << parser.value("assets") << Qt::endl;
+        return 1;
+    }
+
+    // Lives as long as the views that load and search with it.
+    JobSystem jobs(parser.value("jobs").toInt());
+
     // Request OpenGL 3.3 Core
     QSurfaceFormat glFormat;
     glFormat.setProfile(QSurfaceFormat::CoreProfile);
     glFormat.setVersion(3, 3);
-    glFormat.setOption(QSurfaceFormat::DebugContext);
+    // A debug context makes the driver check and report every call.
+    if (EventLog::wantsDebugContext()) {
+        glFormat.setOption(QSurfaceFormat::DebugContext);
+    }
 
     // Some platforms need to explicitly set the depth buffer size (24 bits)
     glFormat.setDepthBufferSize(24);
 
+    // Swapping does not wait for the vertical blank, the frame of an input is shown sooner.
+    if (parser.isSet("low-latency")) {
+        glFormat.setSwapInterval(0);
+    }
+
     QSurfaceFormat::setDefaultFormat(glFormat);
 
-    MainWindow w;
+    if (parser.isSet("grid")) {
+        // Every move of every board would be logged.
+        if (!parser.isSet("diagnostics")) EventLog::setLevel(EventLog::WARNING);
+        GridView grid(qMax(1, parser.value("grid").toInt()));
+        grid.resize(1280, 720);
+        grid.show();
+        return a.exec();
+    }
+
+    startup.begin("main window");
+    MainWindow::Backend backend = MainWindow::OPENGL;
+    if (parser.isSet("software-renderer")) {
+        backend = MainWindow::SOFTWARE;
+    } else if (parser.isSet("render-thread")) {
+        backend = MainWindow::RENDER_THREAD;
+    }
+    MainWindow w(backend);
+    if (SoftwareView *softwareView = dynamic_cast<SoftwareView *>(w.gameView())) {
+        softwareView->setThreadCount(parser.value("threads").toInt());
+    }
+    if (parser.isSet("record")) {
+        w.gameView()->setRecordFile(parser.value("record"));
+    }
+    if (parser.isSet("profile")) {
+        w.gameView()->setProfiling(true);
+    }
+    w.gameView()->setCaptureFile(parser.value("capture"));
+    w.gameView()->setIncrementalRendering(parser.isSet("incremental"));
+    w.gameView()->setLowLatency(parser.isSet("low-latency"));
+    w.gameView()->setBounce(parser.isSet("bounce"));
+    if (parser.isSet("frame-budget")) {
+        w.gameView()->setDynamicResolution(true, frameBudget);
+    }
+    w.gameView()->setShadowMode(shadows);
+
+    int result = 0;
+    // Only the game drawn on the GUI thread is timed.
+    if (w.mainView() && (parser.isSet("startup-profile") || parser.isSet("startup-baseline"))) {
+        w.mainView()->setStartupProfile(&startup);
+        QObject::connect(w.mainView(), &MainView::firstFrameSwapped, [&]() {
+            QTextStream out(stdout);
+            if (parser.isSet("startup-profile")) {
+                out << QJsonDocument(startup.toJson()).toJson();
+            }
+            if (parser.isSet("startup-baseline")) {
+                result = StartupProfile::check(startup, parser.value("startup-baseline"),
+                                               parser.value("startup-threshold").toDouble()) ? 0 : 1;
+                a.quit();
+            }
+        });
+    }
+
+    startup.begin("context");
     w.show();
 
-    return a.exec();
+    int exitCode = a.exec();
+    return result != 0 ? result : exitCode;
 }
@@ -1,97 +1,50 @@
 #ifndef MAINVIEW_H
 #define MAINVIEW_H
 
-#include "model.h"
-#include "disk.h"
+#include "framecapture.h"
+#include "game.h"
+#include "gameview.h"
+#include "latencytracker.h"
+#include "scenerenderer.h"
 
+#include <QElapsedTimer>
 #include <QKeyEvent>
 #include <QMouseEvent>
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLDebugLogger>
-#include <QOpenGLShaderProgram>
 #include <QTimer>
-#include <QVector3D>
-#include <QImage>
-#include <QVector>
-#include <memory>
-#include <QMatrix4x4>
 
-class MainView : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core {
+class MainView : public QOpenGLWidget, public GameView {
     Q_OBJECT
 
-    QOpenGLDebugLogger *debugLogger;
+    QOpenGLDebugLogger *debugLogger = nullptr;
     QTimer timer; // timer used for animation
 
-    QOpenGLShaderProgram normalShaderProgram,
-                         gouraudShaderProgram,
-                         phongShaderProgram;
-
-    // Uniforms for the normal shader.
-    GLint uniformModelViewTransformNormal;
-    GLint uniformProjectionTransformNormal;
-    GLint uniformNormalTransformNormal;
-
-    // Uniforms for the gouraud shader.
-    GLint uniformModelViewTransformGouraud;
-    GLint uniformProjectionTransformGouraud;
-    GLint uniformNormalTransformGouraud;
-
-    GLint uniformMaterialGouraud;
-    GLint uniformLightPositionGouraud;
-    GLint uniformLightColourGouraud;
-
-    GLint uniformTexture1SamplerGouraud;
-
-    // Uniforms for the phong shader.
-    GLint uniformModelViewTransformPhong;
-    GLint uniformProjectionTransformPhong;
-    GLint uniformNormalTransformPhong;
-
-    GLint uniformMaterialPhong;
-    GLint uniformLightPositionPhong;
-    GLint uniformLightColourPhong;
-
-    GLint uniformTexture1SamplerPhong;
-
-    // Buffers
-    GLuint boardVAO, diskVAO, tableVAO;
-    GLuint boardVBO, diskVBO, tableVBO;
-    GLuint boardSize,  diskSize, tableSize;
-
-    // Texture
-    GLuint blue2TexturePtr, grey2TexturePtr, yellow2TexturePtr, red2TexturePtr, yellowTexturePtr, redTexturePtr, woodTexturePtr;
-
-    // Transforms
-    float scale = 1.f;
+    // Draws the scene
+    SceneRenderer renderer;
     QVector3D rotation;
-    QMatrix4x4 projectionTransform;
-    QMatrix4x4 boardTransform, diskTransforms[42], tableTransform, playerDiskTransform;
-
-    // Phong model constants.
-    QVector4D material = {0.5, 0.5, 1, 5};
-    QVector3D lightPosition = {1, 100, 1};
-    QVector3D lightColour = {1, 1, 1};
 
     // Model animation constants.
-    float modelRotation = 1.f;
-    int rollingCatRotation = 2;
     int frameNumber = 0;
+    // Time since the animation last moved on.
+    QElapsedTimer animationClock;
 
     // Game values
-    Disk disks[42];
-    int diskCount = 0;
-    int columnCount[7] = {0,0,0,0,0,0,0};
-    bool yellowPlayer = true;
-    char board[6][7];
-    char gameWinner = '0';
+    Game game;
+
+    StartupProfile *startupProfile = nullptr;
+
+    // Time from an input until its frame is swapped.
+    LatencyTracker latency;
+    bool lowLatency = false;
 
+    // Records the frames, started and stopped in paintGL where the context is current.
+    FrameCapture capture;
+    QString captureFile = "capture.y4m";
+    bool captureToggled = false;
 
 public:
-    enum ShadingMode : GLuint
-    {
-        PHONG = 0, NORMAL, GOURAUD
-    };
+    typedef SceneRenderer::ShadingMode ShadingMode;
 
     MainView(QWidget *parent = 0);
     ~MainView();
@@ -101,11 +54,43 @@ public:
     void setScale(int scale);
     void setShadingMode(ShadingMode shading);
 
+    // Every finished or reset game is appended to this file.
+    void setRecordFile(QString fileName);
+    void setCaptureFile(QString fileName) { captureFile = fileName; }
+    // Starts or stops recording at the next frame.
+    void toggleCapture();
+
     void dropDisk(int column);
-    void drawObject(GLuint texturePtr, GLuint VAO, GLuint size, QMatrix4x4 objectTransform);
+    void undoMove();
+    void redoMove();
     void clearBoard();
-    int isGameWon(int x, int y);
-    
+    void setBounce(bool enabled);
+
+    void setShadowMode(SceneRenderer::ShadowMode mode);
+
+    // Draw the scene at a lower resolution when the GPU needs more than the budget for a frame.
+    void setDynamicResolution(bool enabled, float budgetMilliseconds);
+
+    // Draw the board and the table once, and after that only the disks.
+    void setIncrementalRendering(bool enabled);
+
+    // Draw the frame of an input right away instead of at the next update.
+    void setLowLatency(bool enabled) { lowLatency = enabled; }
+
+    // Frame profiler with an overlay showing the percentiles of the frame
+    // sections and of the input latency.
+    void setProfiling(bool enabled);
+    // Writes the profile to frameprofile.json and frameprofile.trace.json,
+    // and the input latency to latency.json.
+    void dumpProfile();
+
+    // Times the start up until the first frame is swapped. The phase that
+    // runs when the widget is shown ends when the context has been created.
+    void setStartupProfile(StartupProfile *profile);
+
+signals:
+    void firstFrameSwapped();
+
 protected:
     void initializeGL();
     void resizeGL(int newWidth, int newHeight);
@@ -121,35 +106,16 @@ protected:
     void mousePressEvent(QMouseEvent *ev);
     void mouseReleaseEvent(QMouseEvent *ev);
     void wheelEvent(QWheelEvent *ev);
-
-private slots:
-    void onMessageLogged( QOpenGLDebugMessage Message );
+    void leaveEvent(QEvent *ev);
 
 private:
-    void createShaderProgram();
-    void loadMesh();
-
-    // Loads texture data into the buffer of texturePtr.
-    void loadTextures();
-    void loadTexture(QString file, GLuint blue2TexturePtr);
-
-    void destroyModelBuffers();
-
-    void updateProjectionTransform();
-    void updateModelTransforms();
-
-    void updateNormalUniforms(QMatrix4x4 viewTranform, QMatrix3x3 normalTransform);
-    void updateGouraudUniforms(QMatrix4x4 viewTransform, QMatrix3x3 normalTransform);
-    void updatePhongUniforms(QMatrix4x4 viewTransform, QMatrix3x3 normalTransform);
-
-    void updateAnimation();
-
-    // Useful utility method to convert image to bytes.
-    QVector<quint8> imageToBytes(QImage image);
-
-    // The current shader to use.
-    ShadingMode currentShader = PHONG;
+    // Column (1 indexed) of the board under a point of the widget, 0 if there is none.
+    int columnAt(QPoint position) const;
+    // Shows the result of an input, at once in the low latency mode.
+    void showInput();
 
+private slots:
+    void onMessageLogged( QOpenGLDebugMessage Message );
 };
 
 #endif // MAINVIEW_H
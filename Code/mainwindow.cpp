@@ -1,13 +1,37 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "renderwindow.h"
+#include "softwareview.h"
 
 #include "math.h"
 
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow(Backend backend, QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
+    view = ui->mainView;
+
+    QWidget *replacement = nullptr;
+    if (backend == RENDER_THREAD) {
+        RenderWindow *renderWindow = new RenderWindow();
+        replacement = QWidget::createWindowContainer(renderWindow, this);
+        replacement->setFocusPolicy(Qt::StrongFocus);
+        view = renderWindow;
+    } else if (backend == SOFTWARE) {
+        SoftwareView *softwareView = new SoftwareView(this);
+        replacement = softwareView;
+        view = softwareView;
+    }
+
+    if (replacement) {
+        replacement->setSizePolicy(ui->mainView->sizePolicy());
+        ui->horizontalLayout->replaceWidget(ui->mainView, replacement);
+
+        // Never shown, so it never made a context.
+        delete ui->mainView;
+        ui->mainView = nullptr;
+    }
 }
 
 MainWindow::~MainWindow()
@@ -15,8 +39,13 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+MainView *MainWindow::mainView() const
+{
+    return ui->mainView;
+}
+
 // --- Functions that listen for widget events
-// forewards to the mainview
+// forewards to the view of the game
 
 void MainWindow::on_ResetRotationButton_clicked(bool checked)
 {
@@ -24,36 +53,35 @@ void MainWindow::on_ResetRotationButton_clicked(bool checked)
     ui->RotationDialX->setValue(0);
     ui->RotationDialY->setValue(0);
     ui->RotationDialZ->setValue(0);
-    ui->mainView->setRotation(0, 0, 0);
+    view->setRotation(0, 0, 0);
 }
 
 void MainWindow::on_RotationDialX_sliderMoved(int value)
 {
-    ui->mainView->setRotation(value,
-                              ui->RotationDialY->value(),
-                              ui->RotationDialZ->value());
+    view->setRotation(value,
+                      ui->RotationDialY->value(),
+                      ui->RotationDialZ->value());
 }
 
 void MainWindow::on_RotationDialY_sliderMoved(int value)
 {
-    ui->mainView->setRotation(ui->RotationDialX->value(),
-                              value,
-                              ui->RotationDialZ->value());
+    view->setRotation(ui->RotationDialX->value(),
+                      value,
+                      ui->RotationDialZ->value());
 }
 
 void MainWindow::on_RotationDialZ_sliderMoved(int value)
 {
-    ui->mainView->setRotation(ui->RotationDialX->value(),
-                              ui->RotationDialY->value(),
-                              value);
+    view->setRotation(ui->RotationDialX->value(),
+                      ui->RotationDialY->value(),
+                      value);
 }
 
 void MainWindow::on_PhongButton_toggled(bool checked)
 {
     if (checked)
     {
-        ui->mainView->setShadingMode(MainView::PHONG);
-        ui->mainView->update();
+        view->setShadingMode(SceneRenderer::PHONG);
     }
 }
 
@@ -61,8 +89,7 @@ void MainWindow::on_NormalButton_toggled(bool checked)
 {
     if (checked)
     {
-        ui->mainView->setShadingMode(MainView::NORMAL);
-        ui->mainView->update();
+        view->setShadingMode(SceneRenderer::NORMAL);
     }
 }
 
@@ -70,7 +97,14 @@ void MainWindow::on_GouraudButton_toggled(bool checked)
 {
     if (checked)
     {
-        ui->mainView->setShadingMode(MainView::GOURAUD);
-        ui->mainView->update();
+        view->setShadingMode(SceneRenderer::GOURAUD);
+    }
+}
+
+void MainWindow::on_BakedButton_toggled(bool checked)
+{
+    if (checked)
+    {
+        view->setShadingMode(SceneRenderer::BAKED);
     }
 }
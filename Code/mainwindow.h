@@ -3,6 +3,9 @@
 
 #include <QMainWindow>
 
+class GameView;
+class MainView;
+
 namespace Ui {
 class MainWindow;
 }
@@ -12,11 +15,23 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
     Ui::MainWindow *ui;
+    GameView *view;
 
 public:
-    explicit MainWindow(QWidget *parent = 0);
+    // What draws the game: the MainView, a RenderWindow on a thread of its
+    // own, or a SoftwareView on the CPU.
+    enum Backend
+    {
+        OPENGL = 0, RENDER_THREAD, SOFTWARE
+    };
+
+    explicit MainWindow(Backend backend = OPENGL, QWidget *parent = 0);
     ~MainWindow();
 
+    GameView *gameView() const { return view; }
+    // Null unless the game is drawn by the MainView.
+    MainView *mainView() const;
+
 private slots:
     void on_ResetRotationButton_clicked(bool checked);
     void on_RotationDialX_sliderMoved(int value);
@@ -26,6 +41,7 @@ private slots:
     void on_PhongButton_toggled(bool checked);
     void on_NormalButton_toggled(bool checked);
     void on_GouraudButton_toggled(bool checked);
+    void on_BakedButton_toggled(bool checked);
 
 };
 
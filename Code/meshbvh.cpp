@@ -0,0 +1,136 @@
+#include "meshbvh.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Split at the median, the hierarchy is only log2 of the triangle count deep.
+static const int StackSize = 64;
+
+void MeshBvh::build(const QVector<float> &vertices, int stride)
+{
+    nodes.clear();
+    triangles.clear();
+
+    int triangleCount = vertices.size() / (3 * stride);
+    triangles.reserve(triangleCount);
+    for (int i = 0; i < triangleCount; i++) {
+        const float *vertex = vertices.constData() + i * 3 * stride;
+        triangles.push_back({QVector3D(vertex[0], vertex[1], vertex[2]),
+                             QVector3D(vertex[stride], vertex[stride + 1], vertex[stride + 2]),
+                             QVector3D(vertex[2 * stride], vertex[2 * stride + 1], vertex[2 * stride + 2])});
+    }
+
+    if (triangles.empty()) return;
+    nodes.reserve(2 * triangleCount / LeafSize + 1);
+    buildNode(0, triangleCount);
+}
+
+int MeshBvh::buildNode(int begin, int end)
+{
+    int index = static_cast<int>(nodes.size());
+    nodes.push_back(Node());
+
+    QVector3D minimum = triangles[begin].a, maximum = triangles[begin].a;
+    for (int i = begin; i < end; i++) {
+        for (const QVector3D &point : {triangles[i].a, triangles[i].b, triangles[i].c}) {
+            for (int axis = 0; axis < 3; axis++) {
+                minimum[axis] = std::min(minimum[axis], point[axis]);
+                maximum[axis] = std::max(maximum[axis], point[axis]);
+            }
+        }
+    }
+    nodes[index].minimum = minimum;
+    nodes[index].maximum = maximum;
+
+    if (end - begin <= LeafSize) {
+        nodes[index].first = begin;
+        nodes[index].count = end - begin;
+        return index;
+    }
+
+    QVector3D extent = maximum - minimum;
+    int axis = extent.x() > extent.y() ? (extent.x() > extent.z() ? 0 : 2) : (extent.y() > extent.z() ? 1 : 2);
+    int middle = (begin + end) / 2;
+    std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+                     [axis](const Triangle &first, const Triangle &second) {
+                         return first.centre()[axis] < second.centre()[axis];
+                     });
+
+    buildNode(begin, middle);
+    int right = buildNode(middle, end);
+    nodes[index].first = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+// Distance along the ray to the box, or infinity if it misses it.
+static float hitBox(const QVector3D &minimum, const QVector3D &maximum,
+                    const QVector3D &origin, const QVector3D &inverse, float closest)
+{
+    float enter = 0, leave = closest;
+    for (int axis = 0; axis < 3; axis++) {
+        float t1 = (minimum[axis] - origin[axis]) * inverse[axis];
+        float t2 = (maximum[axis] - origin[axis]) * inverse[axis];
+        enter = std::max(enter, std::min(t1, t2));
+        leave = std::min(leave, std::max(t1, t2));
+    }
+    return enter <= leave ? enter : INFINITY;
+}
+
+bool MeshBvh::intersect(QVector3D origin, QVector3D direction, float &distance) const
+{
+    if (nodes.empty()) return false;
+
+    // Divisions by zero give infinities, which the slab test handles.
+    QVector3D inverse(1 / direction.x(), 1 / direction.y(), 1 / direction.z());
+    float closest = INFINITY;
+
+    int stack[StackSize];
+    int size = 0;
+    if (hitBox(nodes[0].minimum, nodes[0].maximum, origin, inverse, closest) < INFINITY) {
+        stack[size++] = 0;
+    }
+
+    while (size > 0) {
+        const Node &node = nodes[stack[--size]];
+
+        if (node.count > 0) {
+            // Möller-Trumbore
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const Triangle &triangle = triangles[i];
+                QVector3D edge1 = triangle.b - triangle.a;
+                QVector3D edge2 = triangle.c - triangle.a;
+                QVector3D p = QVector3D::crossProduct(direction, edge2);
+                float determinant = QVector3D::dotProduct(edge1, p);
+                if (std::fabs(determinant) < 1e-12f) continue;
+
+                QVector3D s = origin - triangle.a;
+                float u = QVector3D::dotProduct(s, p) / determinant;
+                if (u < 0 || u > 1) continue;
+                QVector3D q = QVector3D::crossProduct(s, edge1);
+                float v = QVector3D::dotProduct(direction, q) / determinant;
+                if (v < 0 || u + v > 1) continue;
+
+                float t = QVector3D::dotProduct(edge2, q) / determinant;
+                if (t >= 0 && t < closest) closest = t;
+            }
+            continue;
+        }
+
+        // Visit the nearer child first, it may make the other one too far away.
+        int left = static_cast<int>(&node - nodes.data()) + 1;
+        int right = node.first;
+        float leftDistance = hitBox(nodes[left].minimum, nodes[left].maximum, origin, inverse, closest);
+        float rightDistance = hitBox(nodes[right].minimum, nodes[right].maximum, origin, inverse, closest);
+        if (leftDistance > rightDistance) {
+            std::swap(left, right);
+            std::swap(leftDistance, rightDistance);
+        }
+        if (rightDistance < INFINITY) stack[size++] = right;
+        if (leftDistance < INFINITY) stack[size++] = left;
+    }
+
+    if (closest == INFINITY) return false;
+    distance = closest;
+    return true;
+}
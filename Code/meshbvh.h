@@ -0,0 +1,52 @@
+#ifndef MESHBVH_H
+#define MESHBVH_H
+
+#include <QVector>
+#include <QVector3D>
+#include <vector>
+
+/**
+ * @brief The MeshBvh class
+ *
+ * Bounding volume hierarchy over the triangles of a mesh, to cast rays
+ * against it. A node is split at the median of its triangle centres along
+ * the longest axis of its bounds, until LeafSize triangles are left. The
+ * nodes are stored depth first, the left child right after its parent.
+ */
+class MeshBvh
+{
+public:
+    static const int LeafSize = 4;
+
+    // Builds the hierarchy over interleaved vertices of stride floats that
+    // start with the position, three vertices per triangle.
+    void build(const QVector<float> &vertices, int stride);
+
+    // Finds the nearest hit of the ray origin + distance * direction with
+    // distance >= 0. Returns false if the ray misses the mesh.
+    bool intersect(QVector3D origin, QVector3D direction, float &distance) const;
+
+    int triangleCount() const { return static_cast<int>(triangles.size()); }
+
+private:
+    struct Node
+    {
+        QVector3D minimum, maximum;
+        // A leaf holds count triangles from first, an inner node has
+        // count 0 and its right child at first.
+        int first, count;
+    };
+
+    struct Triangle
+    {
+        QVector3D a, b, c;
+        QVector3D centre() const { return (a + b + c) / 3; }
+    };
+
+    int buildNode(int begin, int end);
+
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+};
+
+#endif // MESHBVH_H
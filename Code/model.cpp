@@ -1,8 +1,14 @@
 #include "model.h"
+#include "eventlog.h"
+#include "jobsystem.h"
 
-#include <QDebug>
 #include <QFile>
 #include <QTextStream>
+#include <memory>
+#include <vector>
+
+// Bytes of the file one job parses.
+static const int ChunkSize = 256 * 1024;
 
 
 // A Private Vertex class for vertex comparison
@@ -28,45 +34,83 @@ struct Vertex {
 };
 
 Model::Model(QString filename) {
-    qDebug() << ":: Loading model:" << filename;
+    EventLog::info("Loading the model %s", qPrintable(filename));
     QFile file(filename);
     if(file.open(QIODevice::ReadOnly)) {
-        QTextStream in(&file);
+        load(file);
+        file.close();
+    }
+}
+
+Model::Model(QIODevice &device) {
+    load(device);
+}
+
+void Model::load(QIODevice &device) {
+    QByteArray text = device.readAll();
+
+    // Lines do not depend on each other, and faces refer to the vertices by
+    // their index in the whole file, so the file is parsed in parts at the
+    // same time and the parts are put together in order.
+    QVector<int> starts;
+    for (int start = 0; start < text.size();) {
+        starts.append(start);
+        int end = text.indexOf('\n', qMin(start + ChunkSize, text.size() - 1));
+        start = end < 0 ? text.size() : end + 1;
+    }
+    starts.append(text.size());
+
+    std::vector<std::unique_ptr<Model>> parts(starts.size() - 1);
+    JobSystem::instance().parallelFor("model", 0, int(parts.size()), 1, [&](int i) {
+        parts[i].reset(new Model);
+        parts[i]->parse(QByteArray::fromRawData(text.constData() + starts[i], starts[i + 1] - starts[i]));
+    });
+    for (const std::unique_ptr<Model> &part : parts) {
+        vertices_indexed += part->vertices_indexed;
+        norm += part->norm;
+        tex += part->tex;
+        indices += part->indices;
+        texcoord_indices += part->texcoord_indices;
+        normal_indices += part->normal_indices;
+        hNorms = hNorms || part->hNorms;
+        hTexs = hTexs || part->hTexs;
+    }
 
-        QString line;
-        QStringList tokens;
+    // create an array version of the data
+    unpackIndexes();
 
-        while(!in.atEnd()) {
-            line = in.readLine();
-            if (line.startsWith("#")) continue; // skip comments
+    // Allign all vertex indices with the right normal/texturecoord indices
+    alignData();
+}
 
-            tokens = line.split(" ", QString::SkipEmptyParts);
+void Model::parse(const QByteArray &text) {
+    QTextStream in(text);
 
-            // Switch depending on first element
-            if (tokens[0] == "v") {
-                parseVertex(tokens);
-            }
+    QString line;
+    QStringList tokens;
 
-            if (tokens[0] == "vn" ) {
-                parseNormal(tokens);
-            }
+    while(!in.atEnd()) {
+        line = in.readLine();
+        if (line.startsWith("#")) continue; // skip comments
 
-            if (tokens[0] == "vt" ) {
-                parseTexture(tokens);
-            }
+        tokens = line.split(" ", Qt::SkipEmptyParts);
 
-            if (tokens[0] == "f" ) {
-                parseFace(tokens);
-            }
+        // Switch depending on first element
+        if (tokens[0] == "v") {
+            parseVertex(tokens);
         }
 
-        file.close();
+        if (tokens[0] == "vn" ) {
+            parseNormal(tokens);
+        }
 
-        // create an array version of the data
-        unpackIndexes();
+        if (tokens[0] == "vt" ) {
+            parseTexture(tokens);
+        }
 
-        // Allign all vertex indices with the right normal/texturecoord indices
-        alignData();
+        if (tokens[0] == "f" ) {
+            parseFace(tokens);
+        }
     }
 }
 
@@ -1,6 +1,7 @@
 #ifndef MODEL_H
 #define MODEL_H
 
+#include <QIODevice>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -20,6 +21,7 @@ class Model
 {
 public:
     Model(QString filename);
+    Model(QIODevice &device);
 
     // Used for glDrawArrays()
     QVector<QVector3D> getVertices();
@@ -48,6 +50,12 @@ public:
 
 private:
 
+    Model() {}
+
+    void load(QIODevice &device);
+    // Lines of the file, without unpacking or aligning them.
+    void parse(const QByteArray &text);
+
     // OBJ parsing
     void parseVertex(QStringList tokens);
     void parseNormal(QStringList tokens);
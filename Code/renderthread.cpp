@@ -0,0 +1,131 @@
+#include "renderthread.h"
+#include "eventlog.h"
+
+#include <QOpenGLDebugLogger>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLPaintDevice>
+#include <QPainter>
+#include <QWindow>
+
+// How long to wait for a snapshot while there is nothing to draw to.
+static const int IdleMilliseconds = 10;
+
+RenderThread::RenderThread(QWindow *window, const QElapsedTimer &clock)
+    : window(window), clock(clock)
+{
+}
+
+void RenderThread::run()
+{
+    QOpenGLContext context;
+    context.setFormat(window->requestedFormat());
+    if (!context.create() || !context.makeCurrent(window)) {
+        EventLog::warning("The render thread could not create an OpenGL context.");
+        return;
+    }
+    QOpenGLFunctions *functions = context.functions();
+
+    // Only a debug context reports messages, see EventLog for when there is one.
+    QOpenGLDebugLogger debugLogger;
+    if (context.format().testOption(QSurfaceFormat::DebugContext) && debugLogger.initialize()) {
+        QObject::connect(&debugLogger, &QOpenGLDebugLogger::messageLogged, &EventLog::logOpenGLMessage);
+        debugLogger.startLogging(EventLog::openGLLoggingMode());
+    }
+
+    renderer.initialize();
+
+    while (running) {
+        if (snapshotBuffer.update()) {
+            const RenderSnapshot &snapshot = snapshotBuffer.front();
+            apply(snapshot);
+            scene = snapshot.scene;
+            unsimulated = snapshot.unsimulated;
+            sceneTime = snapshot.time;
+        }
+
+        if (!applied.exposed || applied.size.isEmpty()) {
+            msleep(IdleMilliseconds);
+            continue;
+        }
+
+        // The disks keep falling while the GUI thread is busy.
+        qint64 now = clock.nsecsElapsed();
+        Game::advance(scene, unsimulated, (now - sceneTime) / 1e9, applied.bounce);
+        sceneTime = now;
+
+        context.makeCurrent(window);
+        functions->glBindFramebuffer(GL_FRAMEBUFFER, context.defaultFramebufferObject());
+        functions->glViewport(0, 0, applied.size.width(), applied.size.height());
+
+        renderer.render(scene);
+        capture.captureFrame();
+        if (applied.profiling) drawOverlay();
+
+        context.swapBuffers(window);
+
+        pickerBuffer.back() = renderer.picker();
+        pickerBuffer.publish();
+    }
+
+    debugLogger.stopLogging();
+    capture.stop();
+    renderer.destroy();
+    context.doneCurrent();
+}
+
+void RenderThread::apply(const RenderSnapshot &snapshot)
+{
+    if (snapshot.size != applied.size && !snapshot.size.isEmpty()) {
+        renderer.resize(snapshot.size.width(), snapshot.size.height());
+    }
+    if (snapshot.rotation != applied.rotation) {
+        renderer.setRotation(snapshot.rotation);
+    }
+    if (snapshot.shading != applied.shading) {
+        renderer.setShadingMode(snapshot.shading);
+    }
+    if (snapshot.shadows != applied.shadows) {
+        renderer.setShadowMode(snapshot.shadows);
+    }
+    if (snapshot.incremental != applied.incremental) {
+        renderer.setIncrementalRendering(snapshot.incremental);
+    }
+    if (snapshot.dynamicResolution != applied.dynamicResolution || snapshot.frameBudget != applied.frameBudget) {
+        renderer.setDynamicResolution(snapshot.dynamicResolution, snapshot.frameBudget);
+    }
+    if (snapshot.profiling != applied.profiling) {
+        renderer.profiler().setEnabled(snapshot.profiling);
+    }
+    if (snapshot.profileDumps != applied.profileDumps) {
+        if (renderer.profiler().writeSummary("frameprofile.json") &&
+            renderer.profiler().writeTrace("frameprofile.trace.json")) {
+            EventLog::info("Wrote the frame profile to frameprofile.json and frameprofile.trace.json.");
+        } else {
+            EventLog::warning("Could not write the frame profile.");
+        }
+    }
+
+    if (snapshot.captureToggles != applied.captureToggles) {
+        if (capture.isCapturing()) {
+            capture.stop();
+        } else {
+            capture.start(snapshot.captureFile, snapshot.size);
+        }
+    }
+
+    applied = snapshot;
+}
+
+void RenderThread::drawOverlay()
+{
+    QOpenGLPaintDevice device(applied.size);
+    device.setDevicePixelRatio(applied.pixelRatio);
+
+    QPainter painter(&device);
+    painter.setPen(Qt::white);
+    painter.setFont(QFont("Monospace", 9));
+    QRect rect(QPoint(0, 0), applied.size / applied.pixelRatio);
+    painter.drawText(rect.adjusted(10, 10, -10, -10), Qt::AlignLeft | Qt::AlignTop,
+                     renderer.profiler().overlayText());
+}
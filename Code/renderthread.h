@@ -0,0 +1,95 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include "framecapture.h"
+#include "scenerenderer.h"
+#include "snapshotbuffer.h"
+
+#include <QElapsedTimer>
+#include <QSize>
+#include <QThread>
+#include <atomic>
+
+class QWindow;
+
+/**
+ * @brief The RenderSnapshot struct
+ *
+ * Everything the render thread draws from: the game and the settings of
+ * the renderer, as the GUI thread last left them.
+ */
+struct RenderSnapshot
+{
+    SceneState scene;
+    // Where the simulation of the game was when the scene was taken, time
+    // is in nanoseconds on the clock the GUI and the render thread share.
+    double unsimulated = 0;
+    qint64 time = 0;
+    bool bounce = false;
+
+    // Of the window, in pixels. Nothing is drawn while it is not exposed.
+    QSize size;
+    qreal pixelRatio = 1;
+    bool exposed = false;
+
+    QVector3D rotation;
+    SceneRenderer::ShadingMode shading = SceneRenderer::PHONG;
+    SceneRenderer::ShadowMode shadows = SceneRenderer::SHADOWS_OFF;
+    bool incremental = false;
+    bool dynamicResolution = false;
+    float frameBudget = 14;
+    bool profiling = false;
+    // The profile is written every time this goes up.
+    int profileDumps = 0;
+    // Recording starts or stops every time this goes up.
+    QString captureFile;
+    int captureToggles = 0;
+};
+
+/**
+ * @brief The RenderThread class
+ *
+ * Draws a window with an OpenGL context of its own, on a thread of its
+ * own, so nothing the GUI thread does holds up a frame. Takes the latest
+ * snapshot before every frame, animates the falling disks on from it by
+ * itself, and waits for the vertical blank in swapBuffers. After every
+ * frame it hands a BoardPicker back, for picking on the GUI thread.
+ */
+class RenderThread : public QThread
+{
+public:
+    RenderThread(QWindow *window, const QElapsedTimer &clock);
+
+    // Written by the GUI thread.
+    SnapshotBuffer<RenderSnapshot> &snapshots() { return snapshotBuffer; }
+    // Read by the GUI thread.
+    SnapshotBuffer<BoardPicker> &pickers() { return pickerBuffer; }
+
+    // Stops after the current frame, wait() for it.
+    void stop() { running = false; }
+
+protected:
+    void run();
+
+private:
+    // Passes the settings that changed on to the renderer.
+    void apply(const RenderSnapshot &snapshot);
+    void drawOverlay();
+
+    QWindow *window;
+    const QElapsedTimer &clock;
+    std::atomic<bool> running{true};
+
+    SnapshotBuffer<RenderSnapshot> snapshotBuffer;
+    SnapshotBuffer<BoardPicker> pickerBuffer;
+
+    // Only used on the render thread.
+    SceneRenderer renderer;
+    FrameCapture capture;
+    RenderSnapshot applied;
+    SceneState scene;
+    double unsimulated = 0;
+    qint64 sceneTime = 0;
+};
+
+#endif // RENDERTHREAD_H
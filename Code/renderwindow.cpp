@@ -0,0 +1,178 @@
+#include "renderwindow.h"
+#include "eventlog.h"
+
+RenderWindow::RenderWindow(QWindow *parent)
+    : QWindow(parent), renderThread(this, clock)
+{
+    setSurfaceType(QWindow::OpenGLSurface);
+    setFormat(QSurfaceFormat::defaultFormat());
+
+    clock.start();
+    game.clear();
+}
+
+RenderWindow::~RenderWindow()
+{
+    // The context of the render thread draws to this window.
+    renderThread.stop();
+    renderThread.wait();
+}
+
+// --- Game logic
+
+void RenderWindow::publish()
+{
+    qint64 now = clock.nsecsElapsed();
+    game.advance((now - advanced) / 1e9);
+    advanced = now;
+
+    RenderSnapshot &snapshot = renderThread.snapshots().back();
+    snapshot = settings;
+    snapshot.scene = game.scene();
+    snapshot.unsimulated = game.unsimulatedSeconds();
+    snapshot.time = now;
+    renderThread.snapshots().publish();
+}
+
+int RenderWindow::columnAt(QPointF position)
+{
+    if (renderThread.pickers().update()) {
+        picker = renderThread.pickers().front();
+    }
+
+    QVector3D hit;
+    if (!picker.pick(position, size(), hit)) return 0;
+    return game.columnAt(hit.x());
+}
+
+void RenderWindow::updateSize()
+{
+    settings.size = size() * devicePixelRatio();
+    settings.pixelRatio = devicePixelRatio();
+    settings.exposed = isExposed();
+}
+
+// --- Window events
+
+void RenderWindow::exposeEvent(QExposeEvent *ev)
+{
+    Q_UNUSED(ev);
+    updateSize();
+    publish();
+
+    if (isExposed() && !renderThread.isRunning()) {
+        renderThread.start();
+    }
+}
+
+void RenderWindow::resizeEvent(QResizeEvent *ev)
+{
+    Q_UNUSED(ev);
+    updateSize();
+    publish();
+}
+
+void RenderWindow::keyPressEvent(QKeyEvent *ev)
+{
+    if (ev->matches(QKeySequence::Undo) || ev->key() == Qt::Key_Backspace) {
+        game.undoMove();
+    } else if (ev->matches(QKeySequence::Redo)) {
+        game.redoMove();
+    } else if (ev->key() >= Qt::Key_1 && ev->key() < Qt::Key_1 + GameBoard::Columns) {
+        game.dropDisk(ev->key() - Qt::Key_0);
+    } else if (ev->key() == Qt::Key_0 || ev->key() == Qt::Key_R) {
+        EventLog::info("The board has been reset.");
+        game.clear();
+    } else if (ev->key() == Qt::Key_P) {
+        settings.profiling = !settings.profiling;
+    } else if (ev->key() == Qt::Key_F9) {
+        settings.captureToggles++;
+    } else if (ev->key() == Qt::Key_F12) {
+        settings.profileDumps++;
+    }
+
+    publish();
+}
+
+void RenderWindow::mouseMoveEvent(QMouseEvent *ev)
+{
+    game.setHoverColumn(columnAt(ev->localPos()));
+    publish();
+}
+
+void RenderWindow::mousePressEvent(QMouseEvent *ev)
+{
+    // Clicking a column drops a disk in it.
+    if (ev->button() == Qt::LeftButton) {
+        int column = columnAt(ev->localPos());
+        if (column > 0) game.dropDisk(column);
+        publish();
+    }
+}
+
+bool RenderWindow::event(QEvent *ev)
+{
+    if (ev->type() == QEvent::Leave) {
+        game.setHoverColumn(0);
+        publish();
+    }
+    return QWindow::event(ev);
+}
+
+// --- Public interface
+
+void RenderWindow::setRotation(int rotateX, int rotateY, int rotateZ)
+{
+    settings.rotation = { static_cast<float>(rotateX), static_cast<float>(rotateY), static_cast<float>(rotateZ) };
+    publish();
+}
+
+void RenderWindow::setShadingMode(SceneRenderer::ShadingMode shading)
+{
+    EventLog::info("Changed shading to %d", shading);
+    settings.shading = shading;
+    publish();
+}
+
+void RenderWindow::setShadowMode(SceneRenderer::ShadowMode mode)
+{
+    settings.shadows = mode;
+    publish();
+}
+
+void RenderWindow::setDynamicResolution(bool enabled, float budgetMilliseconds)
+{
+    settings.dynamicResolution = enabled;
+    settings.frameBudget = budgetMilliseconds;
+    publish();
+}
+
+void RenderWindow::setIncrementalRendering(bool enabled)
+{
+    settings.incremental = enabled;
+    publish();
+}
+
+void RenderWindow::setBounce(bool enabled)
+{
+    settings.bounce = enabled;
+    game.setBounce(enabled);
+    publish();
+}
+
+void RenderWindow::setProfiling(bool enabled)
+{
+    settings.profiling = enabled;
+    publish();
+}
+
+void RenderWindow::setRecordFile(QString fileName)
+{
+    game.setRecordFile(fileName);
+}
+
+void RenderWindow::setCaptureFile(QString fileName)
+{
+    settings.captureFile = fileName;
+    publish();
+}
@@ -0,0 +1,67 @@
+#ifndef RENDERWINDOW_H
+#define RENDERWINDOW_H
+
+#include "game.h"
+#include "gameview.h"
+#include "renderthread.h"
+
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWindow>
+
+/**
+ * @brief The RenderWindow class
+ *
+ * The game drawn on a render thread. The GUI thread handles the input
+ * and the game, and publishes a snapshot after every change; it never
+ * waits for the render thread and the render thread never waits for it.
+ * Picking uses the BoardPicker of the last frame the render thread drew.
+ */
+class RenderWindow : public QWindow, public GameView
+{
+    // Shared with the render thread, started once.
+    QElapsedTimer clock;
+    qint64 advanced = 0;
+
+    Game game;
+
+    // The settings in the next snapshot.
+    RenderSnapshot settings;
+    BoardPicker picker;
+
+    RenderThread renderThread;
+
+public:
+    explicit RenderWindow(QWindow *parent = 0);
+    ~RenderWindow();
+
+    void setRotation(int rotateX, int rotateY, int rotateZ);
+    void setShadingMode(SceneRenderer::ShadingMode shading);
+    void setShadowMode(SceneRenderer::ShadowMode mode);
+    void setDynamicResolution(bool enabled, float budgetMilliseconds);
+    void setIncrementalRendering(bool enabled);
+    // The swap interval of the default format decides, see main.cpp.
+    void setLowLatency(bool enabled) { Q_UNUSED(enabled); }
+    void setBounce(bool enabled);
+    void setProfiling(bool enabled);
+    void setRecordFile(QString fileName);
+    void setCaptureFile(QString fileName);
+
+protected:
+    void exposeEvent(QExposeEvent *ev);
+    void resizeEvent(QResizeEvent *ev);
+    void keyPressEvent(QKeyEvent *ev);
+    void mouseMoveEvent(QMouseEvent *ev);
+    void mousePressEvent(QMouseEvent *ev);
+    bool event(QEvent *ev);
+
+private:
+    // Moves the game on to now and hands it to the render thread with the settings.
+    void publish();
+    void updateSize();
+    // Column (1 indexed) of the board under a point of the window, 0 if there is none.
+    int columnAt(QPointF position);
+};
+
+#endif // RENDERWINDOW_H
@@ -0,0 +1,67 @@
+# The game as it is shown and the OpenGL code that draws it, shared by
+# the game and the headless renderer in tools/render.
+
+# Debug builds count the allocations, a frame that has nothing new to build must not make any.
+CONFIG(debug, debug|release): DEFINES += COUNT_ALLOCATIONS
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/game.cpp \
+    $$PWD/boardwall.cpp \
+    $$PWD/gridrenderer.cpp \
+    $$PWD/softwarerenderer.cpp \
+    $$PWD/scenerenderer.cpp \
+    $$PWD/shadervariants.cpp \
+    $$PWD/shadowmap.cpp \
+    $$PWD/framecapture.cpp \
+    $$PWD/frameencoder.cpp \
+    $$PWD/dynamicresolution.cpp \
+    $$PWD/lightbaker.cpp \
+    $$PWD/meshbvh.cpp \
+    $$PWD/allocationcounter.cpp \
+    $$PWD/frameprofiler.cpp \
+    $$PWD/startupprofile.cpp \
+    $$PWD/eventlog.cpp \
+    $$PWD/model.cpp \
+    $$PWD/assetbundle.cpp
+
+HEADERS += $$PWD/game.h \
+    $$PWD/boardwall.h \
+    $$PWD/gridrenderer.h \
+    $$PWD/softwarerenderer.h \
+    $$PWD/scenerenderer.h \
+    $$PWD/shadervariants.h \
+    $$PWD/shadowmap.h \
+    $$PWD/framecapture.h \
+    $$PWD/frameencoder.h \
+    $$PWD/dynamicresolution.h \
+    $$PWD/lightbaker.h \
+    $$PWD/meshbvh.h \
+    $$PWD/allocationcounter.h \
+    $$PWD/frameprofiler.h \
+    $$PWD/startupprofile.h \
+    $$PWD/eventlog.h \
+    $$PWD/model.h \
+    $$PWD/assetbundle.h \
+    $$PWD/vertex.h \
+    $$PWD/disk.h
+
+# Without a bundle next to the executable the assets are read from here, see assetbundle.h.
+DEFINES += ASSET_DIRECTORY=\\\"$$PWD\\\"
+
+# Linking also builds the packer in packer/ and packs assets.bundle next to
+# the executable, which maps it at start up. Include after TARGET is set.
+ASSET_BUNDLE_DIR = $$OUT_PWD
+!isEmpty(DESTDIR): ASSET_BUNDLE_DIR = $$absolute_path($$DESTDIR, $$OUT_PWD)
+macx:app_bundle: ASSET_BUNDLE_DIR = $$ASSET_BUNDLE_DIR/$${TARGET}.app/Contents/MacOS
+PACKER_DIR = $$OUT_PWD/packer
+PACKER = $$PACKER_DIR/connect4_pack
+win32: PACKER = $${PACKER}.exe
+
+QMAKE_POST_LINK += $$sprintf($$QMAKE_MKDIR_CMD, $$shell_quote($$shell_path($$PACKER_DIR))) $$escape_expand(\\n\\t)
+QMAKE_POST_LINK += cd $$shell_quote($$shell_path($$PACKER_DIR)) && \
+    $$shell_quote($$shell_path($$QMAKE_QMAKE)) $$shell_quote($$shell_path($$PWD/tools/pack/pack.pro)) \
+        CONFIG+=no_self_pack DESTDIR=$$shell_quote($$PACKER_DIR) && \
+    $(MAKE) $$escape_expand(\\n\\t)
+QMAKE_POST_LINK += $$shell_quote($$shell_path($$PACKER)) $$shell_quote($$shell_path($$ASSET_BUNDLE_DIR/assets.bundle))
+QMAKE_CLEAN += $$ASSET_BUNDLE_DIR/assets.bundle
@@ -0,0 +1,772 @@
+#include "scenerenderer.h"
+#include "allocationcounter.h"
+#include "assetbundle.h"
+#include "eventlog.h"
+#include "jobsystem.h"
+
+#include <algorithm>
+
+/**
+ * @brief SceneRenderer::initialize
+ *
+ * Sets up the OpenGL state, shaders, meshes and textures
+ */
+void SceneRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glDepthFunc(GL_LEQUAL);
+    glClearColor(0.0, 1.0, 0.0, 1.0);
+
+    createShaderProgram();
+    loadMesh();
+    loadTextures();
+    shadowMap.initialize(lightPosition);
+    dynamicResolution.initialize();
+    frameProfiler.initialize();
+
+    // Initialize transformations
+    updateProjectionTransform();
+    staticTransformsValid = false;
+    warmUpFrame = true;
+}
+
+/**
+ * @brief SceneRenderer::destroy
+ *
+ * Cleans up the textures and buffers
+ */
+void SceneRenderer::destroy()
+{
+    glDeleteTextures(1, &blue2TexturePtr);
+    glDeleteTextures(1, &grey2TexturePtr);
+    glDeleteTextures(1, &yellow2TexturePtr);
+    glDeleteTextures(1, &red2TexturePtr);
+    glDeleteTextures(1, &yellowTexturePtr);
+    glDeleteTextures(1, &redTexturePtr);
+    glDeleteTextures(1, &woodTexturePtr);
+
+    destroyModelBuffers();
+    boardBake.wait();
+    tableBake.wait();
+    staticLayer.reset();
+    sceneTarget.reset();
+    dynamicResolution.destroy();
+    shadowMap.destroy();
+    shaders.destroy();
+    frameProfiler.destroy();
+}
+
+void SceneRenderer::createShaderProgram()
+{
+    // Build the variants that can be chosen with setShadingMode in advance,
+    // so switching is only a lookup.
+    shaders.setStartupProfile(startupProfile);
+    shaders.build(PHONG | ShaderVariants::TEXTURED);
+    shaders.build(NORMAL);
+    shaders.build(GOURAUD | ShaderVariants::TEXTURED);
+    shaders.build(BAKED | ShaderVariants::TEXTURED);
+}
+
+// Variants with shadows and the depth variant are built when shadows are
+// turned on.
+
+void SceneRenderer::loadMesh()
+{
+    // Loaded at the same time, and uploaded here where the context is current.
+    const char *files[] = {"models/connect4text.obj", "models/disktext.obj", "models/tabletext.obj"};
+    QVector<float> board, disk, table;
+    {
+        StartupPhase phase(startupProfile, "models");
+        QVector<float> *meshes[] = {&board, &disk, &table};
+        JobSystem::instance().parallelFor("load model", 0, 3, 1, [&](int i) {
+            *meshes[i] = AssetBundle::shared().mesh(files[i]);
+        });
+    }
+
+    // The board and the table do not move, their light is baked while the
+    // rest of the scene loads.
+    loadModel(files[0], board, boardVAO, boardVBO, boardSize);
+    boardBake = LightBaker::bake(board, lightPosition, material);
+    {
+        StartupPhase phase(startupProfile, "board bvh");
+        boardBvh = std::make_shared<MeshBvh>();
+        boardBvh->build(board, LightBaker::VertexStride);
+    }
+    loadModel(files[1], disk, diskVAO, diskVBO, diskSize);
+    loadModel(files[2], table, tableVAO, tableVBO, tableSize);
+    tableBake = LightBaker::bake(table, lightPosition, material);
+}
+
+void SceneRenderer::loadModel(QString file, const QVector<float> &data, GLuint &VAO, GLuint &VBO, GLuint &size)
+{
+    StartupPhase phase(startupProfile, "model " + file.section('/', -1));
+
+    size = data.size() / 8;
+
+    // Generate VAO
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    // Generate VBO
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    // Write the data to the buffer
+    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+
+    // Set vertex coordinates to location 0
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0);
+    glEnableVertexAttribArray(0);
+
+    // Set vertex normals to location 1
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // Set vertex texture coordinates to location 2
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // Empty the buffers
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+bool SceneRenderer::uploadBakedLight()
+{
+    if (bakedLight) return true;
+    if (!boardBake.isFinished() || !tableBake.isFinished()) return false;
+
+    attachBakedLight(boardVAO, boardBakedVBO, boardBake.result());
+    attachBakedLight(tableVAO, tableBakedVBO, tableBake.result());
+    bakedLight = true;
+
+    // The static layer still has the Phong shading.
+    invalidateStaticLayer();
+    warmUpFrame = true;
+    return true;
+}
+
+void SceneRenderer::attachBakedLight(GLuint VAO, GLuint &VBO, const QVector<float> &baked)
+{
+    glBindVertexArray(VAO);
+
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, baked.size() * sizeof(float), baked.data(), GL_STATIC_DRAW);
+
+    // Set the ambient and diffuse light to location 7, after the instance transform.
+    glVertexAttribPointer(7, LightBaker::BakedStride, GL_FLOAT, GL_FALSE, LightBaker::BakedStride * sizeof(float), 0);
+    glEnableVertexAttribArray(7);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void SceneRenderer::finishBaking()
+{
+    boardBake.wait();
+    tableBake.wait();
+}
+
+void SceneRenderer::loadTextures()
+{
+    struct
+    {
+        const char *file;
+        GLuint *texturePtr;
+    } textures[] = {
+        {"textures/blue2.png", &blue2TexturePtr},     // Smooth blue texture
+        {"textures/grey2.png", &grey2TexturePtr},     // Smooth grey texture
+        {"textures/yellow2.png", &yellow2TexturePtr}, // Smooth yellow texture
+        {"textures/red2.png", &red2TexturePtr},       // Smooth red texture
+        {"textures/yellow.png", &yellowTexturePtr},   // Bumpy yellow texture
+        {"textures/red.png", &redTexturePtr},         // Bumpy red texture
+        {"textures/wood.png", &woodTexturePtr},       // Wood texture
+    };
+    const int count = sizeof(textures) / sizeof(textures[0]);
+
+    // Decoded at the same time, unless the bundle has them decoded already,
+    // and uploaded one after the other.
+    QImage images[count];
+    {
+        StartupPhase phase(startupProfile, "textures");
+        JobSystem::instance().parallelFor("decode texture", 0, count, 1, [&](int i) {
+            images[i] = AssetBundle::shared().image(textures[i].file);
+        });
+    }
+
+    for (int i = 0; i < count; i++) {
+        glGenTextures(1, textures[i].texturePtr);
+        loadTexture(textures[i].file, images[i], *textures[i].texturePtr);
+    }
+}
+
+void SceneRenderer::loadTexture(QString file, const QImage &image, GLuint texturePtr)
+{
+    StartupPhase phase(startupProfile, "texture " + file.section('/', -1));
+
+    // Set texture parameters: nearest and clamped to the edge both ways,
+    // like the sampler of the SoftwareRenderer.
+    glBindTexture(GL_TEXTURE_2D, texturePtr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Push image data to texture, straight from the bundle when it is decoded there.
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width(), image.height(),
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+}
+
+// --- OpenGL drawing
+
+void SceneRenderer::drawObject(GLuint texturePtr, GLuint VAO, GLuint size, const ObjectTransform &objectTransform)
+{
+    frameProfiler.begin(FrameProfiler::UNIFORMS);
+    glUniformMatrix4fv(activeShader->modelViewTransform, 1, GL_FALSE, objectTransform.model.constData());
+    glUniformMatrix3fv(activeShader->normalTransform, 1, GL_FALSE, objectTransform.normal.constData());
+    frameProfiler.end(FrameProfiler::UNIFORMS);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texturePtr);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, size);
+}
+
+/**
+ * @brief SceneRenderer::render
+ *
+ * Actual function used for drawing the scene
+ *
+ */
+void SceneRenderer::render(const SceneState &scene) {
+    quint64 allocations = AllocationCounter::count();
+    bool steadyFrame = !warmUpFrame;
+    warmUpFrame = false;
+
+    frameProfiler.beginFrame();
+
+    // A new scale needs a new static layer.
+    if (resolutionScaling && beginScaledFrame()) {
+        steadyFrame = false;
+    }
+
+    // A QPainter drawing over the scene, like the profiler overlay, changes these.
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glDisable(GL_SCISSOR_TEST);
+
+    {
+        ProfileScope scope(frameProfiler, FrameProfiler::TRANSFORMS);
+        this->updateModelTransforms(scene);
+    }
+
+    // The board and the table in the static layer show the shadows, so they
+    // have to be drawn again when the shadows change.
+    if (currentShadowMode != SHADOWS_OFF && renderShadowMap(scene)) {
+        invalidateStaticLayer();
+    }
+
+    // Choose the selected shader. Disks move, their light can not be baked.
+    ShaderVariants::Key features = ShaderVariants::TEXTURED;
+    if (currentShadowMode != SHADOWS_OFF) features |= ShaderVariants::SHADOWED;
+    ShadingMode diskShading = currentShader == BAKED ? PHONG : currentShader;
+    bool hadBakedLight = bakedLight;
+    ShadingMode staticShading = currentShader == BAKED && uploadBakedLight() ? BAKED : diskShading;
+    // The bake can land on any frame, the one that switches to it builds the baked variant.
+    if (bakedLight != hadBakedLight) steadyFrame = false;
+    staticShader = staticShading | features;
+    diskShader = diskShading | features;
+
+    // Only the disks move, the board and the table can come from the static layer.
+    if (!incrementalRendering || !compositeStaticLayer(scene)) {
+        drawStaticObjects(scene);
+    }
+    drawDisks(scene);
+
+    activeShader->program.release();
+    activeShader = nullptr;
+
+    if (resolutionScaling) {
+        endScaledFrame();
+    }
+
+    frameProfiler.endFrame();
+
+    Q_ASSERT_X(!steadyFrame || AllocationCounter::count() == allocations, "SceneRenderer::render",
+               "a frame with the same settings as the one before allocated memory");
+}
+
+// Draws the shadow casters into the shadow map. In the cached mode the
+// board, the table and the disks that have landed are drawn only once.
+// Returns true if the shadows changed.
+bool SceneRenderer::renderShadowMap(const SceneState &scene)
+{
+    ProfileScope scope(frameProfiler, FrameProfiler::SHADOWS);
+
+    GLint target = 0;
+    GLint viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    ShaderVariant &depth = shaders.variant(ShaderVariants::DEPTH);
+    depth.program.bind();
+    activeShader = &depth;
+    glUniformMatrix4fv(depth.projectionTransform, 1, GL_FALSE, shadowMap.lightTransform().constData());
+
+    // Against shadow acne, surfaces facing the light must not shadow themselves.
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2, 4);
+
+    bool changed = false;
+    int firstFalling = 0;
+
+    if (currentShadowMode == SHADOWS_CACHED) {
+        // Undoing moves or a new game removes disks from the cache.
+        for (int i = 0; i < shadowCachedDisks && shadowCacheValid; i++) {
+            shadowCacheValid = i < scene.diskCount && scene.disks[i] == shadowDisks[i];
+        }
+
+        if (!shadowCacheValid) {
+            shadowMap.bindCache();
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawDepth(boardVAO, boardSize, boardTransform);
+            drawDepth(tableVAO, tableSize, tableTransform);
+            drawDepth(diskVAO, diskSize, playerDiskTransform);
+            shadowCachedDisks = 0;
+            shadowCacheValid = true;
+            changed = true;
+        }
+
+        // Disks are dropped in order, so they land in order.
+        while (shadowCachedDisks < scene.diskCount && scene.disks[shadowCachedDisks].landed) {
+            shadowMap.bindCache();
+            drawDepth(diskVAO, diskSize, diskTransforms[shadowCachedDisks]);
+            shadowDisks[shadowCachedDisks] = scene.disks[shadowCachedDisks];
+            shadowCachedDisks++;
+            changed = true;
+        }
+
+        firstFalling = shadowCachedDisks;
+        if (firstFalling < scene.diskCount) {
+            shadowMap.copyCacheToFrame();
+        } else {
+            // Disks that fell in the last frame may have been taken back.
+            if (shadowMap.usesFrameMap()) changed = true;
+            shadowMap.bindCache();
+        }
+    } else {
+        shadowMap.bindFrame();
+        glClear(GL_DEPTH_BUFFER_BIT);
+        drawDepth(boardVAO, boardSize, boardTransform);
+        drawDepth(tableVAO, tableSize, tableTransform);
+        drawDepth(diskVAO, diskSize, playerDiskTransform);
+        changed = true;
+    }
+
+    for (int i = firstFalling; i < scene.diskCount; i++) {
+        drawDepth(diskVAO, diskSize, diskTransforms[i]);
+        changed = true;
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    depth.program.release();
+    activeShader = nullptr;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return changed;
+}
+
+void SceneRenderer::drawDepth(GLuint VAO, GLuint size, const ObjectTransform &objectTransform)
+{
+    glUniformMatrix4fv(activeShader->modelViewTransform, 1, GL_FALSE, objectTransform.model.constData());
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, size);
+}
+
+// Clears the framebuffer and draws the board and the table.
+void SceneRenderer::drawStaticObjects(const SceneState &scene)
+{
+    // Clear the screen before rendering
+    frameProfiler.begin(FrameProfiler::CLEAR);
+    glClearColor(0.2f, 0.5f, 0.7f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    frameProfiler.end(FrameProfiler::CLEAR);
+
+    useShader(staticShader);
+
+    // Connect 4 board
+    // Select a different smooth texture depending on who won the game
+    frameProfiler.begin(FrameProfiler::BOARD);
+    switch(scene.gameWinner){
+        case 'y':
+            drawObject(yellow2TexturePtr, boardVAO, boardSize, boardTransform);
+            break;
+        case 'r':
+            drawObject(red2TexturePtr, boardVAO, boardSize, boardTransform);
+            break;
+        case 'd':
+            drawObject(grey2TexturePtr, boardVAO, boardSize, boardTransform);
+            break;
+        default:
+            drawObject(blue2TexturePtr, boardVAO, boardSize, boardTransform);
+            break;
+    }
+    frameProfiler.end(FrameProfiler::BOARD);
+
+    // Table
+    frameProfiler.begin(FrameProfiler::TABLE);
+    drawObject(woodTexturePtr, tableVAO, tableSize, tableTransform);
+    frameProfiler.end(FrameProfiler::TABLE);
+}
+
+void SceneRenderer::drawDisks(const SceneState &scene)
+{
+    useShader(diskShader);
+
+    // Draw every single disk
+    frameProfiler.begin(FrameProfiler::DISKS);
+    for (int i = 0; i < scene.diskCount; i++){
+        if (scene.disks[i].yellowDisk){
+            drawObject(yellowTexturePtr, diskVAO, diskSize, diskTransforms[i]);
+        } else {
+            drawObject(redTexturePtr, diskVAO, diskSize, diskTransforms[i]);
+        }
+    }
+
+    // The disk that shows where a click drops one, smooth to tell it apart.
+    if (scene.hovering) {
+        drawObject(scene.yellowPlayer ? yellow2TexturePtr : red2TexturePtr, diskVAO, diskSize, hoverTransform);
+    }
+
+    // Draw one extra disk on the table that changes color depending on whose turn it is
+    if (scene.yellowPlayer) {
+        drawObject(yellowTexturePtr, diskVAO, diskSize, playerDiskTransform);
+    } else {
+        drawObject(redTexturePtr, diskVAO, diskSize, playerDiskTransform);
+    }
+    frameProfiler.end(FrameProfiler::DISKS);
+}
+
+// Brings the static layer up to date if needed, and copies its colour and
+// depth into the framebuffer that is drawn to, so the disks are depth
+// tested against the board. Returns false if that is not possible.
+bool SceneRenderer::compositeStaticLayer(const SceneState &scene)
+{
+    GLint target = 0;
+    GLint viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    QSize size(viewport[2], viewport[3]);
+
+    if (!staticLayer || staticLayer->size() != size) {
+        staticLayer.reset(new QOpenGLFramebufferObject(size, QOpenGLFramebufferObject::CombinedDepthStencil));
+        staticLayerValid = false;
+        checkComposite = true;
+    }
+
+    if (!staticLayerValid || scene.gameWinner != staticLayerWinner) {
+        staticLayer->bind();
+        glViewport(0, 0, size.width(), size.height());
+        drawStaticObjects(scene);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        staticLayerValid = true;
+        staticLayerWinner = scene.gameWinner;
+    }
+
+    frameProfiler.begin(FrameProfiler::COMPOSITE);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, staticLayer->handle());
+    glBlitFramebuffer(0, 0, size.width(), size.height(),
+                      viewport[0], viewport[1], viewport[0] + size.width(), viewport[1] + size.height(),
+                      GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+    frameProfiler.end(FrameProfiler::COMPOSITE);
+
+    // Depth can only be copied between the same depth formats. Check once,
+    // asking for errors can make the driver wait for the GPU.
+    if (checkComposite) {
+        checkComposite = false;
+        if (glGetError() == GL_INVALID_OPERATION) {
+            EventLog::warning("The static layer can not be copied to this framebuffer, drawing everything every frame.");
+            incrementalRendering = false;
+            staticLayer.reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SceneRenderer::beginScaledFrame()
+{
+    bool changed = dynamicResolution.beginFrame();
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &outputFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, outputViewport);
+
+    // Made as large as the output once, every scale uses a part of it.
+    QSize outputSize(outputViewport[2], outputViewport[3]);
+    if (!sceneTarget || sceneTarget->size() != outputSize) {
+        sceneTarget.reset(new QOpenGLFramebufferObject(outputSize, QOpenGLFramebufferObject::CombinedDepthStencil));
+        changed = true;
+    }
+
+    float scale = dynamicResolution.scale();
+    sceneSize = QSize(qMax(1, qRound(outputSize.width() * scale)), qMax(1, qRound(outputSize.height() * scale)));
+    frameProfiler.setRenderScale(scale);
+
+    sceneTarget->bind();
+    glViewport(0, 0, sceneSize.width(), sceneSize.height());
+    return changed;
+}
+
+void SceneRenderer::endScaledFrame()
+{
+    frameProfiler.begin(FrameProfiler::UPSCALE);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneTarget->handle());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+    glBlitFramebuffer(0, 0, sceneSize.width(), sceneSize.height(),
+                      outputViewport[0], outputViewport[1],
+                      outputViewport[0] + outputViewport[2], outputViewport[1] + outputViewport[3],
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+    glViewport(outputViewport[0], outputViewport[1], outputViewport[2], outputViewport[3]);
+    frameProfiler.end(FrameProfiler::UPSCALE);
+
+    dynamicResolution.endFrame();
+}
+
+void SceneRenderer::invalidateStaticLayer()
+{
+    staticLayerValid = false;
+}
+
+void SceneRenderer::resize(int width, int height)
+{
+    aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+    updateProjectionTransform();
+    invalidateStaticLayer();
+    warmUpFrame = true;
+}
+
+void SceneRenderer::useShader(ShaderVariants::Key key)
+{
+    ShaderVariant *shader = &shaders.variant(key);
+    if (shader == activeShader) return;
+
+    activeShader = shader;
+    activeShader->program.bind();
+    updateFrameUniforms();
+}
+
+void SceneRenderer::updateFrameUniforms()
+{
+    frameProfiler.begin(FrameProfiler::UNIFORMS);
+    glUniformMatrix4fv(activeShader->projectionTransform, 1, GL_FALSE, projectionTransform.constData());
+
+    glUniform4fv(activeShader->material, 1, &material[0]);
+    glUniform3fv(activeShader->lightPosition, 1, &lightPosition[0]);
+    glUniform3fv(activeShader->lightColour, 1, &lightColour[0]);
+
+    glUniform1i(activeShader->texture1Sampler, 0);
+
+    if (currentShadowMode != SHADOWS_OFF) {
+        glUniformMatrix4fv(activeShader->shadowTransform, 1, GL_FALSE, shadowMap.textureTransform().constData());
+        glUniform1i(activeShader->shadowSampler, 1);
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, shadowMap.depthTexture());
+        glActiveTexture(GL_TEXTURE0);
+    }
+    frameProfiler.end(FrameProfiler::UNIFORMS);
+}
+
+void SceneRenderer::updateProjectionTransform()
+{
+    projectionTransform.setToIdentity();
+    projectionTransform.perspective(60, aspectRatio, 0.2, 20);
+
+    // Camera rotation around a point in the world (0, 0, -6)
+    projectionTransform.translate(0, 0, -6);
+    projectionTransform.rotate(rotation.x(), QVector3D (1.0f,0.0f,0.0f));
+    projectionTransform.rotate(rotation.y(), QVector3D (0.0f,1.0f,0.0f));
+    projectionTransform.rotate(rotation.z(), QVector3D (0.0f,0.0f,1.0f));
+    projectionTransform.translate(0, 0, 6);
+}
+
+void SceneRenderer::updateModelTransforms(const SceneState &scene)
+{
+    if (!staticTransformsValid) {
+        // Connect 4 board
+        boardTransform.model.setToIdentity();
+        boardTransform.model.translate(0, 0, -5);
+        // The model has 7 x 6 holes, stretch it to the size of the board that is played.
+        boardTransform.model.scale(scale * 2 * BoardStretchX, scale * 2 * BoardStretchY, scale * 2);
+        boardTransform.updateNormal();
+
+        // Disk on table indicating whose turn it is
+        playerDiskTransform.model.setToIdentity();
+        playerDiskTransform.model.translate(-1.5, -1.3, -4.0);
+        playerDiskTransform.model.scale(scale * 0.2);
+        playerDiskTransform.updateNormal();
+
+        // Table
+        tableTransform.model.setToIdentity();
+        tableTransform.model.translate(0.0, -3.2, -5);
+        tableTransform.model.rotate(90.0, QVector3D(0.0f,1.0f,0.0f));
+        tableTransform.model.scale(scale * 4);
+        tableTransform.updateNormal();
+
+        // Moving a disk does not change its normal transform.
+        QMatrix4x4 diskRotation;
+        diskRotation.rotate(90.0, QVector3D(1.0f,0.0f,0.0f));
+        diskRotation.scale(scale * 0.2);
+        diskNormalTransform = diskRotation.normalMatrix();
+
+        // The disks that have landed are scaled as well.
+        std::fill(diskLanded, diskLanded + GameBoard::Cells, false);
+        staticTransformsValid = true;
+    }
+
+    // Disks
+    for(int i = 0; i < scene.diskCount; i++){
+        const Disk &disk = scene.disks[i];
+        if (diskLanded[i] && transformedDisks[i] == disk) continue;
+
+        QMatrix4x4 &transform = diskTransforms[i].model;
+        transform.setToIdentity();
+        // A falling disk is drawn between where it was at the last two steps of the simulation.
+        transform.translate(disk.x, disk.y + (disk.landed ? 0 : disk.heightAt(scene.interpolation)), -5);
+        transform.rotate(90.0, QVector3D(1.0f,0.0f,0.0f));
+        transform.scale(scale * 0.2);
+        diskTransforms[i].normal = diskNormalTransform;
+
+        transformedDisks[i] = disk;
+        diskLanded[i] = disk.landed;
+    }
+
+    if (scene.hovering) {
+        hoverTransform.model.setToIdentity();
+        hoverTransform.model.translate(scene.hoverDisk.x, scene.hoverDisk.y, -5);
+        hoverTransform.model.rotate(90.0, QVector3D(1.0f,0.0f,0.0f));
+        hoverTransform.model.scale(scale * 0.2);
+        hoverTransform.normal = diskNormalTransform;
+    }
+}
+
+bool SceneRenderer::pickBoard(QPointF position, QSize outputSize, QVector3D &hit) const
+{
+    return picker().pick(position, outputSize, hit);
+}
+
+BoardPicker SceneRenderer::picker() const
+{
+    BoardPicker picker;
+    if (staticTransformsValid) {
+        picker.bvh = boardBvh;
+        picker.projection = projectionTransform;
+        picker.board = boardTransform.model;
+    }
+    return picker;
+}
+
+bool BoardPicker::pick(QPointF position, QSize outputSize, QVector3D &hit) const
+{
+    if (!bvh || outputSize.isEmpty()) return false;
+
+    // From the output to normalized device coordinates, y points up.
+    float x = 2 * position.x() / outputSize.width() - 1;
+    float y = 1 - 2 * position.y() / outputSize.height();
+
+    // The camera is part of the projection, this ends in world coordinates.
+    QMatrix4x4 unproject = projection.inverted();
+    QVector3D nearPoint = unproject.map(QVector3D(x, y, -1));
+    QVector3D farPoint = unproject.map(QVector3D(x, y, 1));
+
+    QMatrix4x4 worldToBoard = board.inverted();
+    QVector3D origin = worldToBoard.map(nearPoint);
+    QVector3D direction = worldToBoard.map(farPoint) - origin;
+
+    float distance;
+    if (!bvh->intersect(origin, direction, distance)) return false;
+    hit = board.map(origin + direction * distance);
+    return true;
+}
+
+// --- OpenGL cleanup helpers
+
+void SceneRenderer::destroyModelBuffers()
+{
+    glDeleteBuffers(1, &boardVBO);
+    glDeleteVertexArrays(1, &boardVAO);
+
+    glDeleteBuffers(1, &diskVBO);
+    glDeleteVertexArrays(1, &diskVAO);
+
+    glDeleteBuffers(1, &tableVBO);
+    glDeleteVertexArrays(1, &tableVAO);
+
+    // Zero until the baked light is uploaded, deleting 0 does nothing.
+    glDeleteBuffers(1, &boardBakedVBO);
+    glDeleteBuffers(1, &tableBakedVBO);
+    bakedLight = false;
+}
+
+// --- Public interface
+
+void SceneRenderer::setRotation(QVector3D rotation)
+{
+    this->rotation = rotation;
+    updateProjectionTransform();
+    invalidateStaticLayer();
+    warmUpFrame = true;
+}
+
+void SceneRenderer::setScale(float scale)
+{
+    this->scale = scale;
+    staticTransformsValid = false;
+    shadowCacheValid = false;
+    invalidateStaticLayer();
+    warmUpFrame = true;
+}
+
+void SceneRenderer::setShadingMode(ShadingMode shading)
+{
+    currentShader = shading;
+    invalidateStaticLayer();
+    warmUpFrame = true;
+}
+
+void SceneRenderer::setShadowMode(ShadowMode mode)
+{
+    currentShadowMode = mode;
+    shadowCacheValid = false;
+    invalidateStaticLayer();
+    warmUpFrame = true;
+}
+
+void SceneRenderer::setDynamicResolution(bool enabled, float budgetMilliseconds)
+{
+    resolutionScaling = enabled;
+    dynamicResolution.setBudget(budgetMilliseconds);
+    if (!enabled) sceneTarget.reset();
+    invalidateStaticLayer();
+    warmUpFrame = true;
+}
+
+void SceneRenderer::setIncrementalRendering(bool enabled)
+{
+    incrementalRendering = enabled;
+    invalidateStaticLayer();
+    warmUpFrame = true;
+}
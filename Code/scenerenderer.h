@@ -0,0 +1,242 @@
+#ifndef SCENERENDERER_H
+#define SCENERENDERER_H
+
+#include "game.h"
+#include "dynamicresolution.h"
+#include "frameprofiler.h"
+#include "lightbaker.h"
+#include "meshbvh.h"
+#include "shadervariants.h"
+#include "shadowmap.h"
+#include "startupprofile.h"
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLFramebufferObject>
+#include <QVector3D>
+#include <QVector4D>
+#include <QImage>
+#include <QVector>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+#include <memory>
+
+/**
+ * @brief The ObjectTransform struct
+ *
+ * The model transform of an object with its normal transform, so the
+ * inverse is only computed when the model transform changes.
+ */
+struct ObjectTransform
+{
+    QMatrix4x4 model;
+    QMatrix3x3 normal;
+
+    void updateNormal() { normal = model.normalMatrix(); }
+};
+
+/**
+ * @brief The BoardPicker struct
+ *
+ * What picking the board needs from a drawn frame. Copying it does not
+ * allocate, and the triangles are shared and never change once built, so
+ * a copy can be used on another thread than the one that draws.
+ */
+struct BoardPicker
+{
+    std::shared_ptr<const MeshBvh> bvh;
+    QMatrix4x4 projection;
+    QMatrix4x4 board;
+
+    // See SceneRenderer::pickBoard.
+    bool pick(QPointF position, QSize outputSize, QVector3D &hit) const;
+};
+
+/**
+ * @brief The SceneRenderer class
+ *
+ * Draws the board, the disks and the table with OpenGL. Does not know
+ * where it draws to: MainView uses it inside a QOpenGLWidget, the headless
+ * renderer in tools/render uses it on an offscreen framebuffer.
+ * All functions have to be called with the OpenGL context current.
+ */
+class SceneRenderer : protected QOpenGLFunctions_3_3_Core
+{
+    // One program for every combination of shading and features.
+    ShaderVariants shaders;
+    // The variant bound while a frame is drawn.
+    ShaderVariant *activeShader = nullptr;
+    // Variants for the board and the table, and for the disks. They only
+    // differ in the baked mode, where the disks keep the Phong shading.
+    ShaderVariants::Key staticShader = 0, diskShader = 0;
+
+    // Buffers
+    GLuint boardVAO, diskVAO, tableVAO;
+    GLuint boardVBO, diskVBO, tableVBO;
+    GLuint boardSize,  diskSize, tableSize;
+
+    // Triangles of the board, in its own coordinates, for picking.
+    std::shared_ptr<MeshBvh> boardBvh;
+
+    // Light baked on the vertices of the board and the table, uploaded
+    // when their jobs are done.
+    LightBaker::Bake boardBake, tableBake;
+    GLuint boardBakedVBO = 0, tableBakedVBO = 0;
+    bool bakedLight = false;
+
+    // Texture
+    GLuint blue2TexturePtr, grey2TexturePtr, yellow2TexturePtr, red2TexturePtr, yellowTexturePtr, redTexturePtr, woodTexturePtr;
+
+    // Transforms
+    float scale = 1.f;
+    float aspectRatio = 1.f;
+    QVector3D rotation;
+    QMatrix4x4 projectionTransform;
+    ObjectTransform boardTransform, diskTransforms[GameBoard::Cells], tableTransform, playerDiskTransform, hoverTransform;
+    // The board, the table and the disk on the table only move when the scale changes.
+    bool staticTransformsValid = false;
+    // Every disk has the same rotation and scale.
+    QMatrix3x3 diskNormalTransform;
+    // Disks whose transform was made for them after they landed keep it.
+    Disk transformedDisks[GameBoard::Cells];
+    bool diskLanded[GameBoard::Cells] = {};
+
+    // Phong model constants.
+    QVector4D material = {0.5, 0.5, 1, 5};
+    QVector3D lightPosition = {1, 100, 1};
+    QVector3D lightColour = {1, 1, 1};
+
+    // The board and the table, with depth, drawn once for the incremental
+    // rendering. Out of date when the camera, the size or the colour of the
+    // board changes.
+    std::unique_ptr<QOpenGLFramebufferObject> staticLayer;
+    bool incrementalRendering = false;
+    bool staticLayerValid = false;
+    bool checkComposite = false;
+    char staticLayerWinner = '0';
+
+    // Shadows of the board, the disks and the table. In the cached mode
+    // the cached map holds the board, the table and the first
+    // shadowCachedDisks disks, which have landed.
+    ShadowMap shadowMap;
+    bool shadowCacheValid = false;
+    int shadowCachedDisks = 0;
+    Disk shadowDisks[GameBoard::Cells];
+
+    // With dynamic resolution the scene is drawn into a corner of the scene
+    // target, as large as the scale allows, and scaled up to the output.
+    DynamicResolution dynamicResolution;
+    bool resolutionScaling = false;
+    std::unique_ptr<QOpenGLFramebufferObject> sceneTarget;
+    QSize sceneSize;
+    GLint outputFramebuffer = 0;
+    GLint outputViewport[4];
+
+    FrameProfiler frameProfiler;
+    StartupProfile *startupProfile = nullptr;
+
+    // The next frame builds what changed settings need and may allocate.
+    // Any other frame must not, which debug builds check.
+    bool warmUpFrame = true;
+
+public:
+    enum ShadingMode : GLuint
+    {
+        PHONG = 0, NORMAL, GOURAUD, BAKED
+    };
+
+    // Uncached draws every shadow caster every frame, to compare with.
+    enum ShadowMode
+    {
+        SHADOWS_OFF = 0, SHADOWS_UNCACHED, SHADOWS_CACHED
+    };
+
+    // Compiles the shaders and uploads the meshes and textures.
+    void initialize();
+    // Times every shader, model and texture in initialize, if set.
+    void setStartupProfile(StartupProfile *profile) { startupProfile = profile; }
+    // Frees the buffers and textures.
+    void destroy();
+
+    void resize(int width, int height);
+    void setRotation(QVector3D rotation);
+    void setScale(float scale);
+    void setShadingMode(ShadingMode shading);
+    ShadingMode shadingMode() const { return currentShader; }
+
+    void setShadowMode(ShadowMode mode);
+    ShadowMode shadowMode() const { return currentShadowMode; }
+
+    // Waits until the light of the baked mode is baked. Until then the
+    // baked mode draws the board and the table with Phong shading.
+    void finishBaking();
+
+    // Draws the board and the table once into a static layer and after
+    // that only the disks on top of it.
+    void setIncrementalRendering(bool enabled);
+    bool isIncrementalRendering() const { return incrementalRendering; }
+
+    // Lowers the resolution of the scene when the GPU needs more than the
+    // budget for a frame, and raises it again when it has time to spare.
+    void setDynamicResolution(bool enabled, float budgetMilliseconds = 14);
+    bool isDynamicResolution() const { return resolutionScaling; }
+    float renderScale() const { return resolutionScaling ? dynamicResolution.scale() : 1.f; }
+
+    // Times the sections of every frame while it is enabled.
+    FrameProfiler &profiler() { return frameProfiler; }
+
+    // Casts a ray through a point of the output, in pixels from its top left
+    // corner, against the board as it was last drawn. Returns false if it
+    // misses the board, otherwise the point it hits in world coordinates.
+    bool pickBoard(QPointF position, QSize outputSize, QVector3D &hit) const;
+    // Picks the board as it was last drawn, from any thread. Picks nothing
+    // before the first frame.
+    BoardPicker picker() const;
+
+    // Draws one frame of the scene, with the falling disks interpolated
+    // between the last two steps of the simulation.
+    void render(const SceneState &scene);
+
+private:
+    void createShaderProgram();
+
+    void loadMesh();
+    // Uploads the interleaved vertices.
+    void loadModel(QString file, const QVector<float> &data, GLuint &VAO, GLuint &VBO, GLuint &size);
+    // Adds the baked light to the VAO, if the worker thread is done.
+    bool uploadBakedLight();
+    void attachBakedLight(GLuint VAO, GLuint &VBO, const QVector<float> &baked);
+
+    // Loads texture data into the buffer of texturePtr.
+    void loadTextures();
+    void loadTexture(QString file, const QImage &image, GLuint texturePtr);
+
+    void destroyModelBuffers();
+
+    void updateProjectionTransform();
+    void updateModelTransforms(const SceneState &scene);
+
+    bool renderShadowMap(const SceneState &scene);
+    void drawDepth(GLuint VAO, GLuint size, const ObjectTransform &objectTransform);
+
+    void drawStaticObjects(const SceneState &scene);
+    void drawDisks(const SceneState &scene);
+    bool compositeStaticLayer(const SceneState &scene);
+
+    // Binds the scene target at the current scale. Returns true if the scale changed.
+    bool beginScaledFrame();
+    void endScaledFrame();
+    void invalidateStaticLayer();
+
+    void drawObject(GLuint texturePtr, GLuint VAO, GLuint size, const ObjectTransform &objectTransform);
+
+    // Binds a variant and sets its frame uniforms, if it is not bound yet.
+    void useShader(ShaderVariants::Key key);
+    // Uniforms that are the same for every object in a frame.
+    void updateFrameUniforms();
+
+    // The current shader to use.
+    ShadingMode currentShader = PHONG;
+    ShadowMode currentShadowMode = SHADOWS_OFF;
+};
+
+#endif // SCENERENDERER_H
@@ -0,0 +1,91 @@
+// Fragment stage of every shader variant, see vertshader_scene.glsl for
+// the #defines.
+
+// The input from the vertex shader.
+#if defined(SHADING_NORMAL) || defined(SHADING_PHONG)
+in vec3 vertNormal;
+#endif
+#ifdef SHADING_PHONG
+in vec3 vertPosition;
+in vec3 relativeLightPosition;
+#endif
+#ifdef SHADING_GOURAUD
+in float ambient, diffuse, specular;
+#endif
+#ifdef SHADING_BAKED
+in vec2 bakedLight;
+#endif
+
+// Lighting model constants.
+#ifdef SHADING_PHONG
+uniform vec4 material;
+#endif
+#if defined(SHADING_GOURAUD) || defined(SHADING_PHONG)
+uniform vec3 lightColour;
+#endif
+
+#ifdef SHADOWED
+in vec4 shadowCoords;
+uniform sampler2DShadow shadowSampler;
+#endif
+
+// Texture sampler
+#ifdef TEXTURED
+in vec2 texCoords;
+uniform sampler2D texture1Sampler;
+#endif
+
+// Specify the output of the fragment shader
+// Usually a vec4 describing a color (Red, Green, Blue, Alpha/Transparency)
+out vec4 fColour;
+
+void main()
+{
+#ifdef SHADOWED
+    // 0 in shadow, 1 in the light, in between at the filtered edges.
+    float lit = textureProj(shadowSampler, shadowCoords);
+#else
+    float lit = 1;
+#endif
+
+#ifdef TEXTURED
+    vec3 texColour = texture(texture1Sampler, texCoords).xyz;
+#else
+    vec3 texColour = vec3(1);
+#endif
+
+#ifdef SHADING_NORMAL
+    fColour = vec4(normalize(vertNormal * 0.5 + 0.5) * (0.5 + 0.5 * lit), 1.0);
+#endif
+
+#ifdef SHADING_GOURAUD
+    // Combine the received components into one colour.
+    fColour = vec4(ambient * texColour + lit * (diffuse + specular) * lightColour * texColour, 1);
+#endif
+
+#ifdef SHADING_BAKED
+    // The ambient and diffuse light only have to be looked up.
+    fColour = vec4(texColour * (bakedLight.x + lit * bakedLight.y), 1);
+#endif
+
+#ifdef SHADING_PHONG
+    // Ambient colour does not depend on any vectors.
+    vec3 colour = material.x * texColour;
+
+    // Calculate light direction vectors in the phong model.
+    vec3 lightDirection = normalize(relativeLightPosition - vertPosition);
+    vec3 normal         = normalize(vertNormal);
+
+    // Diffuse colour.
+    float diffuseIntesity = max(dot(normal, lightDirection), 0);
+    colour += lit * texColour * material.y * diffuseIntesity;
+
+    // Specular colour.
+    vec3 viewDirection     = normalize(-vertPosition); // The camera is always at (0, 0, 0).
+    vec3 reflectDirection  = reflect(-lightDirection, normal);
+    float specularIntesity = max(dot(reflectDirection, viewDirection), 0);
+    colour += lit * texColour * lightColour * material.z * pow(specularIntesity, material.w);
+
+    fColour = vec4(colour, 1);
+#endif
+}
@@ -0,0 +1,132 @@
+// Vertex stage of every shader variant. ShaderVariants puts the #version
+// and the #defines of the variant in front of this source:
+//   SHADING_NORMAL, SHADING_GOURAUD or SHADING_PHONG  the lighting model,
+//   or SHADING_BAKED for light baked into the vertices by LightBaker,
+//   or SHADING_DEPTH to only draw depth, for the shadow map
+//   TEXTURED   the colour comes from texture1Sampler
+//   INSTANCED  the model view transform is a per instance attribute
+//   QUANTIZED  positions are integers, decoded with positionScale and
+//              positionOffset. Normals and texture coordinates are
+//              normalized integers that OpenGL decodes by itself.
+//   SHADOWED   the light is blocked where the shadow map is closer to it
+
+// Specify the input locations of attributes
+layout (location = 0) in vec3 vertCoordinates_in;
+layout (location = 1) in vec3 vertNormals_in;
+layout (location = 2) in vec2 texCoords_in;
+
+// Transformation matrices.
+#ifdef INSTANCED
+layout (location = 3) in mat4 modelViewTransform_in; // Takes locations 3 to 6
+#else
+uniform mat4 modelViewTransform;
+uniform mat3 normalTransform;
+#endif
+uniform mat4 projectionTransform;
+
+#ifdef QUANTIZED
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+#endif
+
+#ifdef SHADOWED
+// From world coordinates to shadow map coordinates.
+uniform mat4 shadowTransform;
+out vec4 shadowCoords;
+#endif
+
+// Lighting model constants.
+#if defined(SHADING_GOURAUD) || defined(SHADING_PHONG)
+uniform vec3 lightPosition;
+#endif
+#ifdef SHADING_GOURAUD
+uniform vec4 material;
+#endif
+
+#ifdef SHADING_BAKED
+// Ambient and diffuse light.
+layout (location = 7) in vec2 bakedLight_in;
+#endif
+
+// Specify the output of the vertex stage
+#if defined(SHADING_NORMAL) || defined(SHADING_PHONG)
+out vec3 vertNormal;
+#endif
+#ifdef SHADING_PHONG
+out vec3 vertPosition;
+out vec3 relativeLightPosition;
+#endif
+#ifdef SHADING_GOURAUD
+out float ambient, diffuse, specular;
+#endif
+#ifdef SHADING_BAKED
+out vec2 bakedLight;
+#endif
+#ifdef TEXTURED
+out vec2 texCoords;
+#endif
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 modelView = modelViewTransform_in;
+    // Instances are only rotated and scaled uniformly, then this is the normal transform.
+    mat3 normalMatrix = mat3(modelView);
+#else
+    mat4 modelView = modelViewTransform;
+    mat3 normalMatrix = normalTransform;
+#endif
+
+#ifdef QUANTIZED
+    vec3 position = vertCoordinates_in * positionScale + positionOffset;
+#else
+    vec3 position = vertCoordinates_in;
+#endif
+
+    vec3 vertexPosition = vec3(modelView * vec4(position, 1));
+    vec3 vertexNormal   = normalize(normalMatrix * vertNormals_in);
+    gl_Position = projectionTransform * vec4(vertexPosition, 1);
+
+#ifdef SHADING_NORMAL
+    vertNormal = vertexNormal;
+#endif
+
+#ifdef SHADING_PHONG
+    // Pass the required information to the fragment stage.
+    relativeLightPosition = vec3(modelView * vec4(lightPosition, 1));
+    vertPosition = vertexPosition;
+    vertNormal   = vertexNormal;
+#endif
+
+#ifdef SHADING_GOURAUD
+    // Ambient component.
+    ambient = material.x;
+
+    // Calculate light direction.
+    vec3 relativeLightPosition = vec3(modelView * vec4(lightPosition, 1));
+    vec3 lightDirection        = normalize(relativeLightPosition - vertexPosition);
+
+    // Diffuse component.
+    float diffuseIntensity = max(dot(vertexNormal, lightDirection), 0);
+    diffuse = material.y * diffuseIntensity;
+
+    // Specular component.
+    vec3 viewDirection      = normalize(-vertexPosition); // The camera is always at (0, 0, 0).
+    vec3 reflectDirection   = reflect(-lightDirection, vertexNormal);
+    float specularIntensity = max(dot(viewDirection, reflectDirection), 0);
+    specular = material.z * pow(specularIntensity, material.w);
+#endif
+
+#ifdef SHADING_BAKED
+    bakedLight = bakedLight_in;
+#endif
+
+#ifdef TEXTURED
+    texCoords = texCoords_in;
+#endif
+
+#ifdef SHADOWED
+    // The model view transform ends in world coordinates, the camera is in the projection.
+    shadowCoords = shadowTransform * vec4(vertexPosition, 1);
+#endif
+}
@@ -0,0 +1,115 @@
+#include "shadervariants.h"
+#include "assetbundle.h"
+#include "eventlog.h"
+
+
+QByteArray ShaderVariants::defines(Key key)
+{
+    // #version has to be the first line of the source.
+    QByteArray defines = "#version 330 core\n";
+
+    switch (key & ShadingMask) {
+        case PHONG:
+            defines += "#define SHADING_PHONG\n";
+            break;
+        case NORMAL:
+            defines += "#define SHADING_NORMAL\n";
+            break;
+        case GOURAUD:
+            defines += "#define SHADING_GOURAUD\n";
+            break;
+        case BAKED:
+            defines += "#define SHADING_BAKED\n";
+            break;
+        case DEPTH:
+            defines += "#define SHADING_DEPTH\n";
+            break;
+    }
+
+    if (key & TEXTURED) defines += "#define TEXTURED\n";
+    if (key & INSTANCED) defines += "#define INSTANCED\n";
+    if (key & QUANTIZED) defines += "#define QUANTIZED\n";
+    if (key & SHADOWED) defines += "#define SHADOWED\n";
+    return defines;
+}
+
+QString ShaderVariants::name(Key key)
+{
+    static const char *shadings[] = {"phong", "normal", "gouraud", "baked", "depth", "", "", ""};
+
+    QString name = shadings[key & ShadingMask];
+    if (key & TEXTURED) name += " textured";
+    if (key & INSTANCED) name += " instanced";
+    if (key & QUANTIZED) name += " quantized";
+    if (key & SHADOWED) name += " shadowed";
+    return name;
+}
+
+ShaderVariants::Key ShaderVariants::normalized(Key key)
+{
+    switch (key & ShadingMask) {
+        case NORMAL:
+            return key & ~TEXTURED;
+        case DEPTH:
+            return key & ~(TEXTURED | SHADOWED);
+        default:
+            return key;
+    }
+}
+
+void ShaderVariants::build(Key key)
+{
+    key = normalized(key);
+    if (variants[key]) return;
+
+    if (vertexSource.isEmpty()) {
+        vertexSource = AssetBundle::shared().file("shaders/vertshader_scene.glsl");
+        fragmentSource = AssetBundle::shared().file("shaders/fragshader_scene.glsl");
+    }
+
+    QByteArray header = defines(key);
+
+    std::unique_ptr<ShaderVariant> variant(new ShaderVariant);
+    QOpenGLShaderProgram &program = variant->program;
+
+    // Cacheable shaders are only compiled when the program is linked, and not
+    // at all when Qt finds a binary of the program in its disk cache. The cache
+    // is keyed by a hash of the sources and the driver version; a binary the
+    // driver rejects is thrown away and the program is built from source.
+    {
+        StartupPhase phase(startupProfile, "shader " + name(key));
+        program.addCacheableShaderFromSourceCode(QOpenGLShader::Vertex, header + vertexSource);
+        program.addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, header + fragmentSource);
+        if (!program.link()) {
+            EventLog::warning("Could not link the %s shader: %s", qPrintable(name(key)), qPrintable(program.log()));
+        }
+    }
+
+    variant->modelViewTransform  = program.uniformLocation("modelViewTransform");
+    variant->projectionTransform = program.uniformLocation("projectionTransform");
+    variant->normalTransform     = program.uniformLocation("normalTransform");
+    variant->material            = program.uniformLocation("material");
+    variant->lightPosition       = program.uniformLocation("lightPosition");
+    variant->lightColour         = program.uniformLocation("lightColour");
+    variant->texture1Sampler     = program.uniformLocation("texture1Sampler");
+    variant->positionScale       = program.uniformLocation("positionScale");
+    variant->positionOffset      = program.uniformLocation("positionOffset");
+    variant->shadowTransform     = program.uniformLocation("shadowTransform");
+    variant->shadowSampler       = program.uniformLocation("shadowSampler");
+
+    variants[key] = std::move(variant);
+}
+
+ShaderVariant &ShaderVariants::variant(Key key)
+{
+    key = normalized(key);
+    if (!variants[key]) build(key);
+    return *variants[key];
+}
+
+void ShaderVariants::destroy()
+{
+    for (std::unique_ptr<ShaderVariant> &variant : variants) {
+        variant.reset();
+    }
+}
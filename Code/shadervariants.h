@@ -0,0 +1,90 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include "startupprofile.h"
+
+#include <QOpenGLShaderProgram>
+#include <memory>
+
+/**
+ * @brief The ShaderVariant struct
+ *
+ * A program built from the scene shaders with one set of features, and
+ * the locations of its uniforms. Uniforms that the variant does not use
+ * have location -1, setting those does nothing.
+ */
+struct ShaderVariant
+{
+    QOpenGLShaderProgram program;
+
+    GLint modelViewTransform;
+    GLint projectionTransform;
+    GLint normalTransform;
+
+    GLint material;
+    GLint lightPosition;
+    GLint lightColour;
+    GLint texture1Sampler;
+
+    GLint positionScale;
+    GLint positionOffset;
+
+    GLint shadowTransform;
+    GLint shadowSampler;
+};
+
+/**
+ * @brief The ShaderVariants class
+ *
+ * Table of the variants of shaders/vertshader_scene.glsl and
+ * shaders/fragshader_scene.glsl. A variant is a lighting model plus
+ * feature flags; each becomes #defines in front of the source, so the
+ * features a variant does not use are compiled out. Variants are built
+ * the first time they are asked for, build() does that in advance.
+ */
+class ShaderVariants
+{
+public:
+    typedef unsigned Key;
+
+    // Lighting models, the same values as SceneRenderer::ShadingMode.
+    // BAKED reads the light from the vertices, DEPTH only draws depth,
+    // for the shadow map.
+    enum Shading : Key
+    {
+        PHONG = 0, NORMAL, GOURAUD, BAKED, DEPTH
+    };
+    static const Key ShadingMask = 7;
+
+    enum Feature : Key
+    {
+        TEXTURED = 1 << 3,
+        INSTANCED = 1 << 4,
+        QUANTIZED = 1 << 5,
+        SHADOWED = 1 << 6
+    };
+
+    static const int VariantCount = 1 << 7;
+
+    // The #defines of a variant.
+    static QByteArray defines(Key key);
+    static QString name(Key key);
+    // The normal shading shows no texture, so it has no textured variant.
+    // Depth has neither a texture nor shadows.
+    static Key normalized(Key key);
+
+    void setStartupProfile(StartupProfile *profile) { startupProfile = profile; }
+
+    void build(Key key);
+    ShaderVariant &variant(Key key);
+
+    // Frees all programs, needs a current context.
+    void destroy();
+
+private:
+    StartupProfile *startupProfile = nullptr;
+    QByteArray vertexSource, fragmentSource;
+    std::unique_ptr<ShaderVariant> variants[VariantCount];
+};
+
+#endif // SHADERVARIANTS_H
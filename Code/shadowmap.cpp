@@ -0,0 +1,88 @@
+#include "shadowmap.h"
+
+// The light is far above the table, the shadow map covers the table.
+static const QVector3D SceneCentre(0, -2, -5);
+static const float SceneRadius = 6;
+
+void ShadowMap::initialize(QVector3D lightPosition)
+{
+    initializeOpenGLFunctions();
+
+    // The maps are created while the caller's framebuffer is bound, keep it bound.
+    GLint previous = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    createMap(cacheFramebuffer, cacheTexture);
+    createMap(frameFramebuffer, frameTexture);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+    // Seen from that far away the light is directional, an orthographic
+    // projection is enough.
+    float distance = (lightPosition - SceneCentre).length();
+    light.setToIdentity();
+    light.ortho(-SceneRadius, SceneRadius, -SceneRadius, SceneRadius,
+                distance - 2 * SceneRadius, distance + 2 * SceneRadius);
+    light.lookAt(lightPosition, SceneCentre, QVector3D(0, 0, -1));
+
+    // Clip space [-1, 1] to texture space [0, 1].
+    texture.setToIdentity();
+    texture.translate(0.5, 0.5, 0.5);
+    texture.scale(0.5);
+    texture *= light;
+}
+
+void ShadowMap::destroy()
+{
+    glDeleteFramebuffers(1, &cacheFramebuffer);
+    glDeleteTextures(1, &cacheTexture);
+    glDeleteFramebuffers(1, &frameFramebuffer);
+    glDeleteTextures(1, &frameTexture);
+}
+
+void ShadowMap::createMap(GLuint &framebuffer, GLuint &depthTexture)
+{
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, Size, Size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+    // Compare in the sampler, with linear filtering that gives soft edges.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    // Outside the map nothing is in shadow.
+    float border[] = {1, 1, 1, 1};
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ShadowMap::bindCache()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, cacheFramebuffer);
+    glViewport(0, 0, Size, Size);
+    useFrame = false;
+}
+
+void ShadowMap::bindFrame()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, frameFramebuffer);
+    glViewport(0, 0, Size, Size);
+    useFrame = true;
+}
+
+void ShadowMap::copyCacheToFrame()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, cacheFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frameFramebuffer);
+    glBlitFramebuffer(0, 0, Size, Size, 0, 0, Size, Size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    bindFrame();
+}
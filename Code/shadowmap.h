@@ -0,0 +1,50 @@
+#ifndef SHADOWMAP_H
+#define SHADOWMAP_H
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <QMatrix4x4>
+#include <QVector3D>
+
+/**
+ * @brief The ShadowMap class
+ *
+ * Depth textures seen from the light. The cached map holds what does not
+ * move: the board, the table and the disks that have landed. The frame map
+ * is a copy of it with the falling disks added, it is only needed while
+ * disks fall.
+ * All functions have to be called with the OpenGL context current.
+ */
+class ShadowMap : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    static const int Size = 2048;
+
+    void initialize(QVector3D lightPosition);
+    void destroy();
+
+    // Light view and projection, from world coordinates to the clip space of the light.
+    const QMatrix4x4 &lightTransform() const { return light; }
+    // From world coordinates to shadow map texture coordinates and depth.
+    const QMatrix4x4 &textureTransform() const { return texture; }
+
+    // Binds a map to draw depth into, with the viewport set to the map.
+    void bindCache();
+    void bindFrame();
+    // Copies the cached map into the frame map and binds the frame map.
+    void copyCacheToFrame();
+
+    // The texture to sample from: the frame map if it was drawn to last.
+    GLuint depthTexture() const { return useFrame ? frameTexture : cacheTexture; }
+    bool usesFrameMap() const { return useFrame; }
+
+private:
+    void createMap(GLuint &framebuffer, GLuint &depthTexture);
+
+    QMatrix4x4 light, texture;
+
+    GLuint cacheFramebuffer = 0, cacheTexture = 0;
+    GLuint frameFramebuffer = 0, frameTexture = 0;
+    bool useFrame = false;
+};
+
+#endif // SHADOWMAP_H
@@ -0,0 +1,54 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+#include <atomic>
+
+/**
+ * @brief The SnapshotBuffer class
+ *
+ * Hands the latest snapshot from one thread to another without locks: a
+ * triple buffer. The writer fills its own slot and swaps it with the
+ * middle one, the reader swaps its own slot with the middle one when that
+ * holds a snapshot it has not seen. Neither ever waits for the other, and
+ * the reader skips snapshots that were replaced before it got to them.
+ *
+ * One thread may write and one may read, T is copied by assignment.
+ */
+template <typename T>
+class SnapshotBuffer
+{
+public:
+    // The slot the writer fills. Keeps what was in it three publishes ago.
+    T &back() { return slots[writeSlot]; }
+
+    // Makes the back slot the latest snapshot.
+    void publish()
+    {
+        int previous = middle.exchange(writeSlot | Fresh, std::memory_order_acq_rel);
+        writeSlot = previous & SlotMask;
+    }
+
+    // Takes the latest snapshot, if one was published since the last
+    // update. Returns false if front() is still the latest.
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & Fresh)) return false;
+        int previous = middle.exchange(readSlot, std::memory_order_acq_rel);
+        readSlot = previous & SlotMask;
+        return true;
+    }
+
+    // The snapshot the reader took last.
+    const T &front() const { return slots[readSlot]; }
+
+private:
+    static const int SlotMask = 3;
+    static const int Fresh = 4;
+
+    T slots[3];
+    int writeSlot = 0;
+    std::atomic<int> middle{1};
+    int readSlot = 2;
+};
+
+#endif // SNAPSHOTBUFFER_H
@@ -0,0 +1,656 @@
+#include "softwarerenderer.h"
+#include "assetbundle.h"
+#include "jobsystem.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// The clear colour of SceneRenderer.
+static const float ClearColour[3] = {0.2f, 0.5f, 0.7f};
+
+// Vertices are snapped to this fraction of a pixel, as a GPU does.
+static const float SubpixelSteps = 16;
+
+// Varyings of the shading modes.
+enum Varying
+{
+    POSITION = 0,   // Phong: 3 floats
+    NORMAL = 3,     // Phong and normal: 3 floats
+    DIFFUSE = 0,    // Gouraud
+    SPECULAR = 1,   // Gouraud
+    TEXTURE = 6     // 2 floats
+};
+
+static quint32 packColour(float r, float g, float b)
+{
+    auto channel = [](float value) { return static_cast<quint32>(qBound(0.f, value, 1.f) * 255 + 0.5f); };
+    return 0xff000000u | channel(r) << 16 | channel(g) << 8 | channel(b);
+}
+
+static void transformPoint(const float *matrix, const float *point, float *out)
+{
+    // Column major, like QMatrix4x4::constData.
+    for (int row = 0; row < 4; row++) {
+        out[row] = matrix[row] * point[0] + matrix[4 + row] * point[1] + matrix[8 + row] * point[2] + matrix[12 + row] * point[3];
+    }
+}
+
+static void normalize(float *vector)
+{
+    float length = std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+    if (length > 0) {
+        vector[0] /= length;
+        vector[1] /= length;
+        vector[2] /= length;
+    }
+}
+
+static float dot(const float *a, const float *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+SoftwareRenderer::SoftwareRenderer()
+    : jobs(&JobSystem::instance())
+{
+    setThreadCount(0);
+    drawCalls.reserve(GameBoard::Cells + 4);
+}
+
+void SoftwareRenderer::initialize()
+{
+    // A job per mesh and texture.
+    struct
+    {
+        const char *file;
+        Mesh *mesh;
+        Texture *texture;
+    } assets[] = {
+        {"models/connect4text.obj", &boardMesh, nullptr},
+        {"models/disktext.obj", &diskMesh, nullptr},
+        {"models/tabletext.obj", &tableMesh, nullptr},
+        {"textures/blue2.png", nullptr, &blue2Texture},
+        {"textures/grey2.png", nullptr, &grey2Texture},
+        {"textures/yellow2.png", nullptr, &yellow2Texture},
+        {"textures/red2.png", nullptr, &red2Texture},
+        {"textures/yellow.png", nullptr, &yellowTexture},
+        {"textures/red.png", nullptr, &redTexture},
+        {"textures/wood.png", nullptr, &woodTexture},
+    };
+    JobSystem::instance().parallelFor("load asset", 0, sizeof(assets) / sizeof(assets[0]), 1, [&](int i) {
+        if (assets[i].mesh) {
+            loadMesh(assets[i].file, *assets[i].mesh);
+        } else {
+            loadTexture(assets[i].file, *assets[i].texture);
+        }
+    });
+
+    boardBvh = std::make_shared<MeshBvh>();
+    boardBvh->build(boardMesh.vertices, 8);
+
+    updateProjectionTransform();
+}
+
+void SoftwareRenderer::loadMesh(QString file, Mesh &mesh)
+{
+    mesh.vertices = AssetBundle::shared().mesh(file);
+    mesh.triangles = mesh.vertices.size() / 24;
+}
+
+void SoftwareRenderer::loadTexture(QString file, Texture &texture)
+{
+    // Rows from the bottom up already.
+    QImage image = AssetBundle::shared().image(file).convertToFormat(QImage::Format_RGB32);
+    texture.width = image.width();
+    texture.height = image.height();
+    texture.texels.resize(texture.width * texture.height);
+    for (int y = 0; y < texture.height; y++) {
+        const quint32 *row = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+        std::copy(row, row + texture.width, texture.texels.begin() + y * texture.width);
+    }
+}
+
+void SoftwareRenderer::resize(int width, int height)
+{
+    this->width = qMax(1, width);
+    this->height = qMax(1, height);
+    aspectRatio = static_cast<float>(this->width) / this->height;
+    updateProjectionTransform();
+
+    frame = QImage(this->width, this->height, QImage::Format_RGB32);
+    depthStride = (this->width + 3) & ~3;
+    depthBuffer.assign(depthStride * this->height, 1.f);
+
+    tileColumns = (this->width + TileSize - 1) / TileSize;
+    tileRows = (this->height + TileSize - 1) / TileSize;
+    for (Worker &worker : workers) {
+        worker.bins.assign(tileColumns * tileRows, std::vector<int>());
+    }
+}
+
+void SoftwareRenderer::setRotation(QVector3D rotation)
+{
+    this->rotation = rotation;
+    updateProjectionTransform();
+}
+
+void SoftwareRenderer::setShadingMode(SceneRenderer::ShadingMode shading)
+{
+    // Nothing is baked here, the baked mode looks like Phong before its light is ready.
+    this->shading = shading == SceneRenderer::BAKED ? SceneRenderer::PHONG : shading;
+}
+
+void SoftwareRenderer::setJobSystem(JobSystem *jobs)
+{
+    this->jobs = jobs;
+}
+
+void SoftwareRenderer::setThreadCount(int threads)
+{
+    if (threads <= 0) threads = jobs->threadCount();
+
+    workers.assign(threads, Worker());
+    for (Worker &worker : workers) {
+        worker.bins.assign(tileColumns * tileRows, std::vector<int>());
+    }
+}
+
+void SoftwareRenderer::updateProjectionTransform()
+{
+    // The same camera as SceneRenderer::updateProjectionTransform.
+    projectionTransform.setToIdentity();
+    projectionTransform.perspective(60, aspectRatio, 0.2, 20);
+    projectionTransform.translate(0, 0, -6);
+    projectionTransform.rotate(rotation.x(), QVector3D(1.0f, 0.0f, 0.0f));
+    projectionTransform.rotate(rotation.y(), QVector3D(0.0f, 1.0f, 0.0f));
+    projectionTransform.rotate(rotation.z(), QVector3D(0.0f, 0.0f, 1.0f));
+    projectionTransform.translate(0, 0, 6);
+
+    boardTransform.setToIdentity();
+    boardTransform.translate(0, 0, -5);
+    boardTransform.scale(2 * BoardStretchX, 2 * BoardStretchY, 2);
+}
+
+BoardPicker SoftwareRenderer::picker() const
+{
+    BoardPicker picker;
+    picker.bvh = boardBvh;
+    picker.projection = projectionTransform;
+    picker.board = boardTransform;
+    return picker;
+}
+
+void SoftwareRenderer::addDrawCall(const Mesh &mesh, const Texture &texture, const QMatrix4x4 &model)
+{
+    DrawCall draw;
+    draw.mesh = &mesh;
+    draw.texture = &texture;
+    draw.modelView = model;
+    draw.normal = model.normalMatrix();
+    draw.light = model.map(lightPosition);
+    drawCalls.push_back(draw);
+}
+
+// The objects in the order SceneRenderer draws them, with the same transforms.
+void SoftwareRenderer::updateDrawCalls(const SceneState &scene)
+{
+    drawCalls.clear();
+
+    switch (scene.gameWinner) {
+        case 'y': addDrawCall(boardMesh, yellow2Texture, boardTransform); break;
+        case 'r': addDrawCall(boardMesh, red2Texture, boardTransform); break;
+        case 'd': addDrawCall(boardMesh, grey2Texture, boardTransform); break;
+        default:  addDrawCall(boardMesh, blue2Texture, boardTransform); break;
+    }
+
+    QMatrix4x4 table;
+    table.translate(0.0, -3.2, -5);
+    table.rotate(90.0, QVector3D(0.0f, 1.0f, 0.0f));
+    table.scale(4);
+    addDrawCall(tableMesh, woodTexture, table);
+
+    for (int i = 0; i < scene.diskCount; i++) {
+        const Disk &disk = scene.disks[i];
+        QMatrix4x4 transform;
+        transform.translate(disk.x, disk.y + (disk.landed ? 0 : disk.heightAt(scene.interpolation)), -5);
+        transform.rotate(90.0, QVector3D(1.0f, 0.0f, 0.0f));
+        transform.scale(0.2f);
+        addDrawCall(diskMesh, disk.yellowDisk ? yellowTexture : redTexture, transform);
+    }
+
+    if (scene.hovering) {
+        QMatrix4x4 transform;
+        transform.translate(scene.hoverDisk.x, scene.hoverDisk.y, -5);
+        transform.rotate(90.0, QVector3D(1.0f, 0.0f, 0.0f));
+        transform.scale(0.2f);
+        addDrawCall(diskMesh, scene.yellowPlayer ? yellow2Texture : red2Texture, transform);
+    }
+
+    QMatrix4x4 playerDisk;
+    playerDisk.translate(-1.5, -1.3, -4.0);
+    playerDisk.scale(0.2f);
+    addDrawCall(diskMesh, scene.yellowPlayer ? yellowTexture : redTexture, playerDisk);
+}
+
+void SoftwareRenderer::render(const SceneState &scene)
+{
+    if (frame.isNull()) resize(width, height);
+
+    frameStatistics = Statistics();
+    QElapsedTimer timer;
+    timer.start();
+
+    updateDrawCalls(scene);
+    for (const DrawCall &draw : drawCalls) {
+        frameStatistics.triangles += draw.mesh->triangles;
+    }
+
+    // Writing to the image through a pointer does not detach it.
+    colourBuffer = reinterpret_cast<quint32 *>(frame.bits());
+
+    runWorkers(&SoftwareRenderer::setupTriangles);
+    qint64 geometryDone = timer.nsecsElapsed();
+    runWorkers(&SoftwareRenderer::drawTiles);
+
+    for (const Worker &worker : workers) {
+        frameStatistics.rasterized += worker.rasterized;
+        frameStatistics.fragments += worker.fragments;
+    }
+    frameStatistics.geometryMilliseconds = geometryDone / 1e6;
+    frameStatistics.rasterMilliseconds = (timer.nsecsElapsed() - geometryDone) / 1e6;
+}
+
+void SoftwareRenderer::runWorkers(void (SoftwareRenderer::*stage)(int))
+{
+    // The calling thread runs parts as well, until all are done.
+    jobs->parallelFor("software stage", 0, threadCount(), 1, [this, stage](int part) { (this->*stage)(part); });
+}
+
+// --- Geometry
+
+void SoftwareRenderer::setupTriangles(int index)
+{
+    Worker &worker = workers[index];
+    worker.triangles.clear();
+    for (std::vector<int> &bin : worker.bins) {
+        bin.clear();
+    }
+    worker.rasterized = 0;
+
+    int count = threadCount();
+    for (int d = 0; d < static_cast<int>(drawCalls.size()); d++) {
+        const DrawCall &draw = drawCalls[d];
+        int first = draw.mesh->triangles * index / count;
+        int last = draw.mesh->triangles * (index + 1) / count;
+
+        const float *vertices = draw.mesh->vertices.constData();
+        for (int t = first; t < last; t++) {
+            ClipVertex clipped[3];
+            for (int k = 0; k < 3; k++) {
+                transformVertex(draw, vertices + (3 * t + k) * 8, clipped[k]);
+            }
+            clipTriangle(clipped, d, worker);
+        }
+    }
+}
+
+// What the vertex shader does.
+void SoftwareRenderer::transformVertex(const DrawCall &draw, const float *vertex, ClipVertex &out) const
+{
+    float position[4] = {vertex[0], vertex[1], vertex[2], 1};
+    float view[4];
+    transformPoint(draw.modelView.constData(), position, view);
+    transformPoint(projectionTransform.constData(), view, out.position);
+
+    // Column major as well.
+    const float *n = draw.normal.constData();
+    float normal[3];
+    for (int row = 0; row < 3; row++) {
+        normal[row] = n[row] * vertex[3] + n[3 + row] * vertex[4] + n[6 + row] * vertex[5];
+    }
+    normalize(normal);
+
+    float *varyings = out.varyings;
+    std::fill(varyings, varyings + Varyings, 0.f);
+    varyings[TEXTURE] = vertex[6];
+    varyings[TEXTURE + 1] = vertex[7];
+
+    if (shading == SceneRenderer::GOURAUD) {
+        float lightDirection[3] = {draw.light.x() - view[0], draw.light.y() - view[1], draw.light.z() - view[2]};
+        normalize(lightDirection);
+        float diffuse = qMax(dot(normal, lightDirection), 0.f);
+
+        float viewDirection[3] = {-view[0], -view[1], -view[2]};
+        normalize(viewDirection);
+        float reflection = 2 * dot(normal, lightDirection);
+        float reflectDirection[3];
+        for (int i = 0; i < 3; i++) {
+            reflectDirection[i] = reflection * normal[i] - lightDirection[i];
+        }
+        float specular = qMax(dot(viewDirection, reflectDirection), 0.f);
+
+        varyings[DIFFUSE] = material.y() * diffuse;
+        varyings[SPECULAR] = material.z() * std::pow(specular, material.w());
+    } else {
+        std::copy(view, view + 3, varyings + POSITION);
+        std::copy(normal, normal + 3, varyings + NORMAL);
+    }
+}
+
+// Clips against the near plane, the other planes are handled by the
+// bounding box and the depth test.
+void SoftwareRenderer::clipTriangle(const ClipVertex *vertices, int draw, Worker &worker) const
+{
+    // Entirely outside one side of the view.
+    for (int axis = 0; axis < 3; axis++) {
+        bool below = true, above = true;
+        for (int k = 0; k < 3; k++) {
+            const float *p = vertices[k].position;
+            below = below && p[axis] < -p[3];
+            above = above && p[axis] > p[3];
+        }
+        if (below || above) return;
+    }
+
+    float distance[3];
+    int inside = 0;
+    for (int k = 0; k < 3; k++) {
+        distance[k] = vertices[k].position[2] + vertices[k].position[3];
+        if (distance[k] >= 0) inside++;
+    }
+    if (inside == 3) {
+        setupTriangle(vertices[0], vertices[1], vertices[2], draw, worker);
+        return;
+    }
+
+    // A triangle cut by a plane has at most four corners.
+    ClipVertex polygon[4];
+    int corners = 0;
+    for (int k = 0; k < 3; k++) {
+        const ClipVertex &current = vertices[k];
+        const ClipVertex &next = vertices[(k + 1) % 3];
+        float d0 = distance[k], d1 = distance[(k + 1) % 3];
+        if (d0 >= 0) polygon[corners++] = current;
+        if ((d0 >= 0) != (d1 >= 0)) {
+            float t = d0 / (d0 - d1);
+            ClipVertex &cut = polygon[corners++];
+            for (int i = 0; i < 4; i++) {
+                cut.position[i] = current.position[i] + t * (next.position[i] - current.position[i]);
+            }
+            for (int i = 0; i < Varyings; i++) {
+                cut.varyings[i] = current.varyings[i] + t * (next.varyings[i] - current.varyings[i]);
+            }
+        }
+    }
+    for (int k = 2; k < corners; k++) {
+        setupTriangle(polygon[0], polygon[k - 1], polygon[k], draw, worker);
+    }
+}
+
+void SoftwareRenderer::setupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, int draw, Worker &worker) const
+{
+    const ClipVertex *vertices[3] = {&v0, &v1, &v2};
+    float x[3], y[3], z[3], inverseW[3];
+    for (int k = 0; k < 3; k++) {
+        const float *p = vertices[k]->position;
+        inverseW[k] = 1 / p[3];
+        // From the top left corner of the image, y points down.
+        x[k] = std::round((p[0] * inverseW[k] + 1) * 0.5f * width * SubpixelSteps) / SubpixelSteps;
+        y[k] = std::round((1 - p[1] * inverseW[k]) * 0.5f * height * SubpixelSteps) / SubpixelSteps;
+        z[k] = p[2] * inverseW[k] * 0.5f + 0.5f;
+    }
+
+    // Counter clockwise is the front in OpenGL, with y pointing down it
+    // has a negative area. The back faces are culled, as SceneRenderer does.
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area >= 0) return;
+
+    // Clockwise from here on, so the inside is where the edge functions are positive.
+    std::swap(x[1], x[2]);
+    std::swap(y[1], y[2]);
+    std::swap(z[1], z[2]);
+    std::swap(inverseW[1], inverseW[2]);
+    std::swap(vertices[1], vertices[2]);
+    area = -area;
+
+    Triangle triangle;
+    triangle.minX = qMax(0, static_cast<int>(std::floor(std::min({x[0], x[1], x[2]}))));
+    triangle.minY = qMax(0, static_cast<int>(std::floor(std::min({y[0], y[1], y[2]}))));
+    triangle.maxX = qMin(width - 1, static_cast<int>(std::ceil(std::max({x[0], x[1], x[2]}))));
+    triangle.maxY = qMin(height - 1, static_cast<int>(std::ceil(std::max({y[0], y[1], y[2]}))));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+    // The edge opposite each vertex.
+    for (int k = 0; k < 3; k++) {
+        int from = (k + 1) % 3, to = (k + 2) % 3;
+        float dx = x[to] - x[from], dy = y[to] - y[from];
+        triangle.a[k] = -dy;
+        triangle.b[k] = dx;
+        triangle.c[k] = dy * x[from] - dx * y[from];
+        triangle.owns[k] = triangle.a[k] > 0 || (triangle.a[k] == 0 && triangle.b[k] > 0);
+    }
+
+    auto plane = [&](float f0, float f1, float f2) {
+        Plane p;
+        p.dx = ((f1 - f0) * (y[2] - y[0]) - (f2 - f0) * (y[1] - y[0])) / area;
+        p.dy = ((f2 - f0) * (x[1] - x[0]) - (f1 - f0) * (x[2] - x[0])) / area;
+        p.base = f0 - p.dx * x[0] - p.dy * y[0];
+        return p;
+    };
+    triangle.depth = plane(z[0], z[1], z[2]);
+    triangle.inverseW = plane(inverseW[0], inverseW[1], inverseW[2]);
+    for (int i = 0; i < Varyings; i++) {
+        triangle.varyings[i] = plane(vertices[0]->varyings[i] * inverseW[0],
+                                     vertices[1]->varyings[i] * inverseW[1],
+                                     vertices[2]->varyings[i] * inverseW[2]);
+    }
+    triangle.draw = draw;
+
+    int index = static_cast<int>(worker.triangles.size());
+    worker.triangles.push_back(triangle);
+    worker.rasterized++;
+
+    // Only into the tiles the triangle touches, not every tile of its bounding box.
+    for (int row = triangle.minY / TileSize; row <= triangle.maxY / TileSize; row++) {
+        for (int column = triangle.minX / TileSize; column <= triangle.maxX / TileSize; column++) {
+            float left = column * TileSize, right = left + TileSize;
+            float top = row * TileSize, bottom = top + TileSize;
+            bool touches = true;
+            for (int k = 0; k < 3 && touches; k++) {
+                // The corner of the tile where the edge function is the largest.
+                float cornerX = triangle.a[k] > 0 ? right : left;
+                float cornerY = triangle.b[k] > 0 ? bottom : top;
+                touches = triangle.a[k] * cornerX + triangle.b[k] * cornerY + triangle.c[k] >= 0;
+            }
+            if (touches) worker.bins[row * tileColumns + column].push_back(index);
+        }
+    }
+}
+
+// --- Rasterization
+
+void SoftwareRenderer::drawTiles(int index)
+{
+    Worker &worker = workers[index];
+    worker.fragments = 0;
+
+    int tileCount = tileColumns * tileRows;
+    for (int tile = index; tile < tileCount; tile += threadCount()) {
+        drawTile(tile, worker);
+    }
+}
+
+void SoftwareRenderer::drawTile(int tile, Worker &worker)
+{
+    int x0 = (tile % tileColumns) * TileSize, y0 = (tile / tileColumns) * TileSize;
+    int x1 = qMin(x0 + TileSize, width) - 1, y1 = qMin(y0 + TileSize, height) - 1;
+
+    quint32 clear = packColour(ClearColour[0], ClearColour[1], ClearColour[2]);
+    for (int y = y0; y <= y1; y++) {
+        std::fill(colourBuffer + y * width + x0, colourBuffer + y * width + x1 + 1, clear);
+        std::fill(depthBuffer.begin() + y * depthStride + x0, depthBuffer.begin() + y * depthStride + x1 + 1, 1.f);
+    }
+
+    // In the order the workers set them up, each in the order of the objects.
+    for (const Worker &source : workers) {
+        for (int index : source.bins[tile]) {
+            const Triangle &triangle = source.triangles[index];
+            rasterize(triangle, qMax(x0, triangle.minX), qMax(y0, triangle.minY),
+                      qMin(x1, triangle.maxX), qMin(y1, triangle.maxY), worker);
+        }
+    }
+}
+
+void SoftwareRenderer::rasterize(const Triangle &triangle, int x0, int y0, int x1, int y1, Worker &worker)
+{
+    if (x0 > x1 || y0 > y1) return;
+
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 lanes = _mm_set_ps(3, 2, 1, 0);
+
+    __m128 a[3], owns[3], step[3];
+    for (int k = 0; k < 3; k++) {
+        a[k] = _mm_set1_ps(triangle.a[k]);
+        step[k] = _mm_set1_ps(4 * triangle.a[k]);
+        owns[k] = _mm_castsi128_ps(_mm_set1_epi32(triangle.owns[k] ? -1 : 0));
+    }
+    const __m128 depthDx = _mm_set1_ps(triangle.depth.dx);
+    const __m128 depthStep = _mm_set1_ps(4 * triangle.depth.dx);
+
+    // Groups of four start at a multiple of four, then they never reach
+    // into the tile of another thread. Tiles and depth rows are multiples of four.
+    int firstX = x0 & ~3;
+    const __m128 left = _mm_set1_ps(static_cast<float>(x0));
+    const __m128 right = _mm_set1_ps(static_cast<float>(x1));
+
+    for (int y = y0; y <= y1; y++) {
+        float centreY = y + 0.5f;
+        __m128 centreX = _mm_add_ps(_mm_set1_ps(firstX + 0.5f), lanes);
+
+        __m128 edge[3];
+        for (int k = 0; k < 3; k++) {
+            edge[k] = _mm_add_ps(_mm_mul_ps(a[k], centreX), _mm_set1_ps(triangle.b[k] * centreY + triangle.c[k]));
+        }
+        __m128 depth = _mm_add_ps(_mm_mul_ps(depthDx, centreX), _mm_set1_ps(triangle.depth.dy * centreY + triangle.depth.base));
+
+        float *depthRow = depthBuffer.data() + y * depthStride;
+        for (int x = firstX; x <= x1; x += 4) {
+            __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+            __m128 covered = _mm_and_ps(_mm_cmpge_ps(pixelX, left), _mm_cmple_ps(pixelX, right));
+            for (int k = 0; k < 3; k++) {
+                __m128 inside = _mm_or_ps(_mm_cmpgt_ps(edge[k], zero),
+                                          _mm_and_ps(_mm_cmpeq_ps(edge[k], zero), owns[k]));
+                covered = _mm_and_ps(covered, inside);
+            }
+
+            if (_mm_movemask_ps(covered)) {
+                // GL_LEQUAL, and nothing beyond the far plane.
+                __m128 stored = _mm_loadu_ps(depthRow + x);
+                __m128 passed = _mm_and_ps(covered, _mm_and_ps(_mm_cmple_ps(depth, stored),
+                                                               _mm_and_ps(_mm_cmpge_ps(depth, zero), _mm_cmple_ps(depth, one))));
+                int mask = _mm_movemask_ps(passed);
+                if (mask) {
+                    _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(passed, depth), _mm_andnot_ps(passed, stored)));
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (mask & (1 << lane)) {
+                            colourBuffer[y * width + x + lane] = shade(triangle, x + lane + 0.5f, centreY);
+                            worker.fragments++;
+                        }
+                    }
+                }
+            }
+
+            for (int k = 0; k < 3; k++) {
+                edge[k] = _mm_add_ps(edge[k], step[k]);
+            }
+            depth = _mm_add_ps(depth, depthStep);
+        }
+    }
+#else
+    for (int y = y0; y <= y1; y++) {
+        float centreY = y + 0.5f;
+        float *depthRow = depthBuffer.data() + y * depthStride;
+        for (int x = x0; x <= x1; x++) {
+            float centreX = x + 0.5f;
+            bool covered = true;
+            for (int k = 0; k < 3 && covered; k++) {
+                float edge = triangle.a[k] * centreX + triangle.b[k] * centreY + triangle.c[k];
+                covered = edge > 0 || (edge == 0 && triangle.owns[k]);
+            }
+            if (!covered) continue;
+
+            float depth = triangle.depth.at(centreX, centreY);
+            if (depth > depthRow[x] || depth < 0 || depth > 1) continue;
+            depthRow[x] = depth;
+            colourBuffer[y * width + x] = shade(triangle, centreX, centreY);
+            worker.fragments++;
+        }
+    }
+#endif
+}
+
+// What the fragment shader does.
+quint32 SoftwareRenderer::shade(const Triangle &triangle, float x, float y) const
+{
+    const DrawCall &draw = drawCalls[triangle.draw];
+    float w = 1 / triangle.inverseW.at(x, y);
+    float varyings[Varyings];
+    for (int i = 0; i < Varyings; i++) {
+        varyings[i] = triangle.varyings[i].at(x, y) * w;
+    }
+
+    if (shading == SceneRenderer::NORMAL) {
+        float colour[3];
+        for (int i = 0; i < 3; i++) {
+            colour[i] = varyings[NORMAL + i] * 0.5f + 0.5f;
+        }
+        normalize(colour);
+        return packColour(colour[0], colour[1], colour[2]);
+    }
+
+    // Nearest and clamped to the edge, as SceneRenderer::loadTexture sets it up.
+    const Texture &texture = *draw.texture;
+    float u = varyings[TEXTURE], v = varyings[TEXTURE + 1];
+    int column = qBound(0, static_cast<int>(std::floor(u * texture.width)), texture.width - 1);
+    int row = qBound(0, static_cast<int>(std::floor(v * texture.height)), texture.height - 1);
+    quint32 texel = texture.texels[row * texture.width + column];
+    float texColour[3] = {qRed(texel) / 255.f, qGreen(texel) / 255.f, qBlue(texel) / 255.f};
+
+    float ambient = material.x(), diffuse, specular;
+    if (shading == SceneRenderer::GOURAUD) {
+        diffuse = varyings[DIFFUSE];
+        specular = varyings[SPECULAR];
+    } else {
+        const float *position = varyings + POSITION;
+        float lightDirection[3] = {draw.light.x() - position[0], draw.light.y() - position[1], draw.light.z() - position[2]};
+        normalize(lightDirection);
+        float normal[3] = {varyings[NORMAL], varyings[NORMAL + 1], varyings[NORMAL + 2]};
+        normalize(normal);
+        diffuse = material.y() * qMax(dot(normal, lightDirection), 0.f);
+
+        float viewDirection[3] = {-position[0], -position[1], -position[2]};
+        normalize(viewDirection);
+        float reflection = 2 * dot(normal, lightDirection);
+        float reflectDirection[3];
+        for (int i = 0; i < 3; i++) {
+            reflectDirection[i] = reflection * normal[i] - lightDirection[i];
+        }
+        specular = material.z() * std::pow(qMax(dot(reflectDirection, viewDirection), 0.f), material.w());
+    }
+
+    // Gouraud has the light colour on the diffuse light as well, Phong does not.
+    float colour[3];
+    for (int i = 0; i < 3; i++) {
+        float light = shading == SceneRenderer::GOURAUD ? (diffuse + specular) * lightColour[i]
+                                                        : diffuse + specular * lightColour[i];
+        colour[i] = (ambient + light) * texColour[i];
+    }
+    return packColour(colour[0], colour[1], colour[2]);
+}
@@ -0,0 +1,189 @@
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include "game.h"
+#include "jobsystem.h"
+#include "scenerenderer.h"
+
+#include <QImage>
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+#include <QVector>
+#include <QVector3D>
+#include <QVector4D>
+#include <vector>
+
+/**
+ * @brief The SoftwareRenderer class
+ *
+ * Draws the same scene as SceneRenderer on the CPU, for hosts without a
+ * GPU or with an OpenGL that is too slow. The image is split into tiles
+ * of TileSize pixels, and the frame is split into parts that each have a
+ * set of them. A frame has two stages, each a parallelFor over the parts
+ * on the JobSystem: first every part transforms, clips and sets up its
+ * share of the triangles of every object and sorts them into the tiles
+ * they touch, then every part draws its own tiles, so no two jobs write
+ * the same pixel. Coverage and depth are tested four pixels at once with
+ * SSE, with a plain C++ fallback.
+ *
+ * The shading follows shaders/: Phong, Gouraud and normal. The baked mode
+ * draws Phong, like SceneRenderer before the light is baked, and there are
+ * no shadows. Textures are sampled nearest, as SceneRenderer sets them up.
+ */
+class SoftwareRenderer
+{
+public:
+    static const int TileSize = 64;
+
+    struct Statistics
+    {
+        int triangles = 0;  // Of the objects in the frame
+        int rasterized = 0; // Left after culling and clipping
+        qint64 fragments = 0; // Pixels that passed the depth test
+        double geometryMilliseconds = 0;
+        double rasterMilliseconds = 0;
+    };
+
+    SoftwareRenderer();
+
+    // Loads the meshes and textures.
+    void initialize();
+
+    void resize(int width, int height);
+    void setRotation(QVector3D rotation);
+    void setShadingMode(SceneRenderer::ShadingMode shading);
+
+    // The job system the parts run on, JobSystem::instance() by default.
+    // Lets connect4_render measure thread counts.
+    void setJobSystem(JobSystem *jobs);
+    // Parts a frame is split into. 0 uses one per thread of the job system.
+    void setThreadCount(int threads);
+    int threadCount() const { return static_cast<int>(workers.size()); }
+
+    void render(const SceneState &scene);
+
+    // The last frame.
+    const QImage &image() const { return frame; }
+    const Statistics &statistics() const { return frameStatistics; }
+
+    // Picks the board as it was last drawn, see SceneRenderer::picker.
+    BoardPicker picker() const;
+
+private:
+    // Floats per vertex that are interpolated over a triangle.
+    static const int Varyings = 8;
+
+    // Interleaved like Model::getVNTInterleaved, 8 floats per vertex.
+    struct Mesh
+    {
+        QVector<float> vertices;
+        int triangles = 0;
+    };
+
+    // Rows from the bottom up, as OpenGL has them.
+    struct Texture
+    {
+        int width = 0, height = 0;
+        std::vector<quint32> texels;
+    };
+
+    struct DrawCall
+    {
+        const Mesh *mesh;
+        const Texture *texture;
+        QMatrix4x4 modelView;
+        QMatrix3x3 normal;
+        // relativeLightPosition of the shaders.
+        QVector3D light;
+    };
+
+    struct ClipVertex
+    {
+        float position[4];
+        float varyings[Varyings];
+    };
+
+    // A value over the screen: dx * x + dy * y + base.
+    struct Plane
+    {
+        float dx, dy, base;
+        float at(float x, float y) const { return dx * x + dy * y + base; }
+    };
+
+    struct Triangle
+    {
+        // Edge functions a x + b y + c, inside the triangle where all three
+        // are positive. A pixel on an edge belongs to the edge that owns it,
+        // so a pixel on an edge that two triangles share is drawn once.
+        float a[3], b[3], c[3];
+        bool owns[3];
+        int minX, minY, maxX, maxY;
+        Plane depth;
+        Plane inverseW;
+        // The varyings divided by w, for perspective correct interpolation.
+        Plane varyings[Varyings];
+        int draw;
+    };
+
+    struct Worker
+    {
+        std::vector<Triangle> triangles;
+        // Indices into triangles, per tile.
+        std::vector<std::vector<int>> bins;
+        int rasterized = 0;
+        qint64 fragments = 0;
+    };
+
+    void loadMesh(QString file, Mesh &mesh);
+    void loadTexture(QString file, Texture &texture);
+
+    void updateProjectionTransform();
+    void updateDrawCalls(const SceneState &scene);
+    void addDrawCall(const Mesh &mesh, const Texture &texture, const QMatrix4x4 &model);
+
+    // Runs a stage on every worker, worker 0 on the calling thread.
+    void runWorkers(void (SoftwareRenderer::*stage)(int));
+
+    // Stage one: the triangles of worker.
+    void setupTriangles(int worker);
+    void transformVertex(const DrawCall &draw, const float *vertex, ClipVertex &out) const;
+    void clipTriangle(const ClipVertex *vertices, int draw, Worker &worker) const;
+    void setupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, int draw, Worker &worker) const;
+
+    // Stage two: the tiles of worker.
+    void drawTiles(int worker);
+    void drawTile(int tile, Worker &worker);
+    void rasterize(const Triangle &triangle, int x0, int y0, int x1, int y1, Worker &worker);
+    quint32 shade(const Triangle &triangle, float x, float y) const;
+
+    Mesh boardMesh, diskMesh, tableMesh;
+    Texture blue2Texture, grey2Texture, yellow2Texture, red2Texture, yellowTexture, redTexture, woodTexture;
+    std::shared_ptr<MeshBvh> boardBvh;
+
+    QVector3D rotation;
+    float aspectRatio = 1.f;
+    QMatrix4x4 projectionTransform, boardTransform;
+    SceneRenderer::ShadingMode shading = SceneRenderer::PHONG;
+
+    // Same constants as SceneRenderer.
+    QVector4D material = {0.5, 0.5, 1, 5};
+    QVector3D lightPosition = {1, 100, 1};
+    QVector3D lightColour = {1, 1, 1};
+
+    std::vector<DrawCall> drawCalls;
+
+    int width = 0, height = 0;
+    int tileColumns = 0, tileRows = 0;
+    QImage frame;
+    quint32 *colourBuffer = nullptr;
+    // Rows padded to a multiple of four pixels, so the last group of a row can be loaded whole.
+    std::vector<float> depthBuffer;
+    int depthStride = 0;
+
+    JobSystem *jobs = nullptr;
+    std::vector<Worker> workers;
+
+    Statistics frameStatistics;
+};
+
+#endif // SOFTWARERENDERER_H
@@ -0,0 +1,116 @@
+#include "softwareview.h"
+#include "eventlog.h"
+
+#include <QPainter>
+
+SoftwareView::SoftwareView(QWidget *parent) : QWidget(parent)
+{
+    connect(&timer, SIGNAL(timeout()), this, SLOT(update()));
+
+    setMouseTracking(true);
+    setFocusPolicy(Qt::StrongFocus);
+    // Every pixel is drawn by paintEvent.
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    renderer.initialize();
+    game.clear();
+    timer.start(1000.0 / 60.0);
+}
+
+void SoftwareView::paintEvent(QPaintEvent *ev)
+{
+    Q_UNUSED(ev);
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+
+    qint64 nanoseconds = animationClock.isValid() ? animationClock.nsecsElapsed() : 0;
+    animationClock.start();
+    game.advance(nanoseconds / 1e9);
+
+    renderer.render(game.scene());
+
+    QPainter painter(this);
+    painter.drawImage(rect(), renderer.image());
+
+    if (profiling) {
+        const SoftwareRenderer::Statistics &statistics = renderer.statistics();
+        QString text = QString("software, %1 threads\nframe     %2 ms\ngeometry  %3 ms\nraster    %4 ms\n%5 of %6 triangles, %7 fragments")
+                .arg(renderer.threadCount()).arg(frameMilliseconds, 0, 'f', 2)
+                .arg(statistics.geometryMilliseconds, 0, 'f', 2).arg(statistics.rasterMilliseconds, 0, 'f', 2)
+                .arg(statistics.rasterized).arg(statistics.triangles).arg(statistics.fragments);
+        painter.setPen(Qt::white);
+        painter.setFont(QFont("Monospace", 9));
+        painter.drawText(rect().adjusted(10, 10, -10, -10), Qt::AlignLeft | Qt::AlignTop, text);
+    }
+
+    frameMilliseconds = frameTimer.nsecsElapsed() / 1e6;
+}
+
+void SoftwareView::resizeEvent(QResizeEvent *ev)
+{
+    Q_UNUSED(ev);
+    renderer.resize(width() * devicePixelRatio(), height() * devicePixelRatio());
+}
+
+int SoftwareView::columnAt(QPointF position) const
+{
+    QVector3D hit;
+    if (!renderer.picker().pick(position, size(), hit)) return 0;
+    return game.columnAt(hit.x());
+}
+
+void SoftwareView::keyPressEvent(QKeyEvent *ev)
+{
+    if (ev->matches(QKeySequence::Undo) || ev->key() == Qt::Key_Backspace) {
+        game.undoMove();
+    } else if (ev->matches(QKeySequence::Redo)) {
+        game.redoMove();
+    } else if (ev->key() >= Qt::Key_1 && ev->key() < Qt::Key_1 + GameBoard::Columns) {
+        game.dropDisk(ev->key() - Qt::Key_0);
+    } else if (ev->key() == Qt::Key_0 || ev->key() == Qt::Key_R) {
+        EventLog::info("The board has been reset.");
+        game.clear();
+    } else if (ev->key() == Qt::Key_P) {
+        profiling = !profiling;
+    } else {
+        QWidget::keyPressEvent(ev);
+        return;
+    }
+    update();
+}
+
+void SoftwareView::mouseMoveEvent(QMouseEvent *ev)
+{
+    game.setHoverColumn(columnAt(ev->localPos()));
+    update();
+}
+
+void SoftwareView::mousePressEvent(QMouseEvent *ev)
+{
+    // Clicking a column drops a disk in it.
+    if (ev->button() == Qt::LeftButton) {
+        int column = columnAt(ev->localPos());
+        if (column > 0) game.dropDisk(column);
+        update();
+    }
+}
+
+void SoftwareView::leaveEvent(QEvent *ev)
+{
+    Q_UNUSED(ev);
+    game.setHoverColumn(0);
+    update();
+}
+
+void SoftwareView::setRotation(int rotateX, int rotateY, int rotateZ)
+{
+    renderer.setRotation(QVector3D(rotateX, rotateY, rotateZ));
+    update();
+}
+
+void SoftwareView::setShadingMode(SceneRenderer::ShadingMode shading)
+{
+    EventLog::info("Changed shading to %d", shading);
+    renderer.setShadingMode(shading);
+    update();
+}
@@ -0,0 +1,66 @@
+#ifndef SOFTWAREVIEW_H
+#define SOFTWAREVIEW_H
+
+#include "game.h"
+#include "gameview.h"
+#include "softwarerenderer.h"
+
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QTimer>
+#include <QWidget>
+
+/**
+ * @brief The SoftwareView class
+ *
+ * The game drawn by the SoftwareRenderer into a plain widget, for hosts
+ * where the OpenGL 3.3 context fails or is too slow. Takes the same
+ * input as MainView. Shadows, dynamic resolution, the incremental
+ * rendering and the frame capture need OpenGL and are ignored.
+ */
+class SoftwareView : public QWidget, public GameView
+{
+    Q_OBJECT
+
+    QTimer timer;
+    QElapsedTimer animationClock;
+
+    Game game;
+    SoftwareRenderer renderer;
+
+    bool profiling = false;
+    // Of the last frame, with the drawing of the image.
+    double frameMilliseconds = 0;
+
+public:
+    explicit SoftwareView(QWidget *parent = 0);
+
+    void setRotation(int rotateX, int rotateY, int rotateZ);
+    void setShadingMode(SceneRenderer::ShadingMode shading);
+    void setShadowMode(SceneRenderer::ShadowMode mode) { Q_UNUSED(mode); }
+    void setDynamicResolution(bool enabled, float budgetMilliseconds) { Q_UNUSED(enabled); Q_UNUSED(budgetMilliseconds); }
+    void setIncrementalRendering(bool enabled) { Q_UNUSED(enabled); }
+    void setLowLatency(bool enabled) { Q_UNUSED(enabled); }
+    void setBounce(bool enabled) { game.setBounce(enabled); }
+    void setProfiling(bool enabled) { profiling = enabled; }
+    void setRecordFile(QString fileName) { game.setRecordFile(fileName); }
+    void setCaptureFile(QString fileName) { Q_UNUSED(fileName); }
+
+    // 0 uses one thread per core.
+    void setThreadCount(int threads) { renderer.setThreadCount(threads); }
+
+protected:
+    void paintEvent(QPaintEvent *ev);
+    void resizeEvent(QResizeEvent *ev);
+    void keyPressEvent(QKeyEvent *ev);
+    void mouseMoveEvent(QMouseEvent *ev);
+    void mousePressEvent(QMouseEvent *ev);
+    void leaveEvent(QEvent *ev);
+
+private:
+    // Column (1 indexed) of the board under a point of the widget, 0 if there is none.
+    int columnAt(QPointF position) const;
+};
+
+#endif // SOFTWAREVIEW_H
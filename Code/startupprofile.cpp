@@ -0,0 +1,99 @@
+#include "startupprofile.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTextStream>
+
+// Phases may be this many milliseconds slower than the factor allows,
+// timing a phase of a few microseconds is mostly noise.
+static const double Slack = 2.0;
+
+void StartupProfile::begin(const QString &name)
+{
+    end();
+    phaseList.append({name, clock.nsecsElapsed(), -1});
+}
+
+void StartupProfile::end()
+{
+    if (phaseList.isEmpty() || phaseList.last().duration >= 0) return;
+
+    Phase &phase = phaseList.last();
+    phase.duration = clock.nsecsElapsed() - phase.start;
+}
+
+double StartupProfile::totalMilliseconds() const
+{
+    if (phaseList.isEmpty()) return 0;
+
+    const Phase &last = phaseList.last();
+    return (last.start + qMax<qint64>(last.duration, 0)) / 1e6;
+}
+
+QJsonObject StartupProfile::toJson() const
+{
+    QJsonArray phases;
+    for (const Phase &phase : phaseList) {
+        QJsonObject object;
+        object["name"] = phase.name;
+        object["start"] = phase.start / 1e6;
+        object["duration"] = qMax<qint64>(phase.duration, 0) / 1e6;
+        phases.append(object);
+    }
+
+    QJsonObject report;
+    report["unit"] = QString("ms");
+    report["total"] = totalMilliseconds();
+    report["phases"] = phases;
+    return report;
+}
+
+QStringList StartupProfile::regressions(const QJsonObject &baseline, double factor, double slack) const
+{
+    QStringList slower;
+    QJsonObject current = toJson();
+
+    // Compare the phases by name, a phase that is not in the baseline is new and not compared.
+    QJsonObject baselineDurations;
+    for (const QJsonValue &phase : baseline["phases"].toArray()) {
+        baselineDurations[phase.toObject()["name"].toString()] = phase.toObject()["duration"];
+    }
+
+    for (const QJsonValue &value : current["phases"].toArray()) {
+        QJsonObject phase = value.toObject();
+        QString name = phase["name"].toString();
+        double duration = phase["duration"].toDouble();
+        if (!baselineDurations.contains(name)) continue;
+
+        double before = baselineDurations[name].toDouble();
+        if (duration > factor * before + slack) {
+            slower.append(QString("%1: %2 ms, was %3 ms").arg(name).arg(duration, 0, 'f', 2).arg(before, 0, 'f', 2));
+        }
+    }
+
+    double total = current["total"].toDouble();
+    double totalBefore = baseline["total"].toDouble();
+    if (totalBefore > 0 && total > factor * totalBefore + slack) {
+        slower.append(QString("total: %1 ms, was %2 ms").arg(total, 0, 'f', 2).arg(totalBefore, 0, 'f', 2));
+    }
+    return slower;
+}
+
+bool StartupProfile::check(const StartupProfile &profile, const QString &fileName, double factor)
+{
+    QTextStream err(stderr);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << "Could not read the start up baseline " << fileName << Qt::endl;
+        return false;
+    }
+    QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+
+    QStringList slower = profile.regressions(baseline, factor, Slack);
+    for (const QString &phase : slower) {
+        err << "Slower start up: " << phase << Qt::endl;
+    }
+    return slower.isEmpty();
+}
@@ -0,0 +1,70 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief The StartupProfile class
+ *
+ * Times the phases of starting up, one after the other, from the moment
+ * the profile is constructed. Beginning a phase ends the one before it.
+ */
+class StartupProfile
+{
+public:
+    struct Phase
+    {
+        QString name;
+        qint64 start;    // Nanoseconds since the profile was constructed
+        qint64 duration; // Nanoseconds, -1 while the phase runs
+    };
+
+    StartupProfile() { clock.start(); }
+
+    void begin(const QString &name);
+    void end();
+
+    const QVector<Phase> &phases() const { return phaseList; }
+    // End of the last phase.
+    double totalMilliseconds() const;
+
+    // The phases as JSON, with the times in milliseconds.
+    QJsonObject toJson() const;
+
+    // Phases that took more than factor times as long as in the baseline, a
+    // report from toJson, plus slack milliseconds so that very short phases
+    // do not fail on noise.
+    QStringList regressions(const QJsonObject &baseline, double factor, double slack) const;
+
+    // Compares the profile with the baseline report in fileName and prints
+    // the phases that got slower. Returns false if there are any.
+    static bool check(const StartupProfile &profile, const QString &fileName, double factor);
+
+private:
+    QElapsedTimer clock;
+    QVector<Phase> phaseList;
+};
+
+/**
+ * @brief The StartupPhase class
+ *
+ * Times a phase until the end of the scope, if there is a profile.
+ */
+class StartupPhase
+{
+public:
+    StartupPhase(StartupProfile *profile, const QString &name) : profile(profile)
+    {
+        if (profile) profile->begin(name);
+    }
+    ~StartupPhase() { if (profile) profile->end(); }
+
+private:
+    StartupProfile *profile;
+};
+
+#endif // STARTUPPROFILE_H
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Measures how the job system scales
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = connect4_jobs
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../../engine.pri)
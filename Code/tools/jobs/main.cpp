@@ -0,0 +1,231 @@
+#include "board.h"
+#include "agents.h"
+#include "jobsystem.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * Scaling benchmark for the job system.
+ *
+ * Runs the same two workloads with every thread count: a parallelFor that
+ * evaluates many random positions, which has no dependencies at all, and
+ * alpha-beta searches of some of them, which split the root moves into
+ * jobs. Reports the time, the speedup and efficiency relative to the
+ * first thread count, and the jobs run and stolen. The results have to be
+ * the same with every thread count, or it exits with an error:
+ *
+ *   connect4_jobs --threads 1,2,4,8 --depth 9 --trace jobs.json
+ */
+
+typedef Board<7, 6, 4> Game;
+
+// Positions of random games, none of them over.
+static std::vector<Game> randomPositions(int count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> moveCount(4, Game::Cells / 2);
+    std::uniform_int_distribution<int> columns(0, Game::Columns - 1);
+
+    std::vector<Game> positions(count);
+    for (Game &game : positions) {
+        for (int moves = moveCount(generator); moves > 0; moves--) {
+            int column = columns(generator);
+            if (!game.canPlay(column)) continue;
+            if (game.play(column) != Game::UNFINISHED) {
+                game.undo(column);
+                break;
+            }
+        }
+    }
+    return positions;
+}
+
+struct Run
+{
+    int threads = 0;
+    double evaluateSeconds = 0;
+    double searchSeconds = 0;
+    long long scoreSum = 0;
+    std::vector<int> moves;
+    long long nodes = 0;
+    JobSystem::Statistics statistics;
+};
+
+static Run measure(int threads, const std::vector<Game> &positions, int searches, int depth,
+                   std::vector<JobSystem::TraceEvent> *trace, std::mutex &traceMutex)
+{
+    Run run;
+    JobSystem jobs(threads);
+    run.threads = jobs.threadCount();
+    if (trace) {
+        jobs.setTraceHook([trace, &traceMutex](const JobSystem::TraceEvent &event) {
+            std::lock_guard<std::mutex> lock(traceMutex);
+            trace->push_back(event);
+        });
+    }
+
+    std::vector<int> scores(positions.size());
+    QElapsedTimer timer;
+    timer.start();
+    jobs.parallelFor("evaluate", 0, int(positions.size()), 256, [&](int i) {
+        scores[i] = AlphaBetaAgent<Game>::evaluatePosition(positions[i]);
+    });
+    run.evaluateSeconds = timer.nsecsElapsed() / 1e9;
+    for (int score : scores) run.scoreSum += score;
+
+    // One search after the other, each splits its root moves into jobs.
+    timer.restart();
+    AlphaBetaAgent<Game> agent(depth);
+    for (int i = 0; i < searches; i++) {
+        Game game = positions[i];
+        run.moves.push_back(agent.chooseMove(game));
+        run.nodes += agent.nodeCount();
+    }
+    run.searchSeconds = timer.nsecsElapsed() / 1e9;
+
+    run.statistics = jobs.statistics();
+    return run;
+}
+
+static bool writeTrace(const QString &fileName, const std::vector<std::vector<JobSystem::TraceEvent>> &traces,
+                       const std::vector<Run> &runs)
+{
+    // A process per run, a thread per worker, in microseconds.
+    QJsonArray events;
+    for (size_t run = 0; run < runs.size(); run++) {
+        QJsonObject args;
+        args["name"] = QString("%1 threads").arg(runs[run].threads);
+        QJsonObject process;
+        process["name"] = QString("process_name");
+        process["ph"] = QString("M");
+        process["pid"] = int(run + 1);
+        process["args"] = args;
+        events.append(process);
+
+        for (const JobSystem::TraceEvent &traceEvent : traces[run]) {
+            QJsonObject event;
+            event["name"] = QString(traceEvent.name);
+            event["ph"] = QString("X");
+            event["pid"] = int(run + 1);
+            event["tid"] = traceEvent.thread + 1; // 0 is the main thread
+            event["ts"] = traceEvent.start / 1e3;
+            event["dur"] = (traceEvent.end - traceEvent.start) / 1e3;
+            events.append(event);
+        }
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = QString("ms");
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_jobs");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures how the job system scales with the number of threads.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"threads", "Comma separated thread counts, powers of two up to one per core by default.", "counts"},
+        {"positions", "Random positions to evaluate.", "n", "200000"},
+        {"searches", "Positions to search for the best move.", "n", "16"},
+        {"depth", "Depth of the searches.", "d", "8"},
+        {"seed", "Seed of the random positions.", "seed", "1"},
+        {"trace", "Write every job of every run to this Chrome trace.", "file"},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if ((parser.isSet("threads") && !checkInteger(parser, "threads", 1, err)) ||
+        !checkInteger(parser, "positions", 1, err) || !checkInteger(parser, "searches", 0, err) ||
+        !checkInteger(parser, "depth", 1, err)) {
+        return 1;
+    }
+
+    std::vector<int> threadCounts;
+    if (parser.isSet("threads")) {
+        for (const QString &count : parser.value("threads").split(',')) {
+            threadCounts.push_back(count.toInt());
+        }
+    } else {
+        int cores = qMax(1u, std::thread::hardware_concurrency());
+        for (int count = 1; count < cores; count *= 2) threadCounts.push_back(count);
+        threadCounts.push_back(cores);
+    }
+
+    int positionCount = parser.value("positions").toInt();
+    int searches = qMin(parser.value("searches").toInt(), positionCount);
+    int depth = parser.value("depth").toInt();
+    std::vector<Game> positions = randomPositions(positionCount, parser.value("seed").toUInt());
+
+    std::vector<Run> runs;
+    std::vector<std::vector<JobSystem::TraceEvent>> traces(threadCounts.size());
+    std::mutex traceMutex;
+
+    // The parallel searches visit more nodes, they cannot all use the bounds of the moves before them.
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10")
+           .arg("threads", 7).arg("evaluate ms", 12).arg("speedup", 8).arg("efficiency", 10)
+           .arg("search ms", 10).arg("speedup", 8).arg("efficiency", 10).arg("nodes", 12)
+           .arg("jobs", 10).arg("steals", 8) << Qt::endl;
+    for (size_t i = 0; i < threadCounts.size(); i++) {
+        runs.push_back(measure(threadCounts[i], positions, searches, depth,
+                               parser.isSet("trace") ? &traces[i] : nullptr, traceMutex));
+        const Run &run = runs.back();
+        const Run &first = runs.front();
+
+        if (run.scoreSum != first.scoreSum || run.moves != first.moves) {
+            err << "The results with " << run.threads << " threads differ from those with "
+                << first.threads << " threads." << Qt::endl;
+            return 1;
+        }
+
+        double evaluateSpeedup = run.evaluateSeconds > 0 ? first.evaluateSeconds / run.evaluateSeconds : 0;
+        double searchSpeedup = run.searchSeconds > 0 ? first.searchSeconds / run.searchSeconds : 0;
+        double scale = double(first.threads) / run.threads;
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10")
+               .arg(run.threads, 7).arg(run.evaluateSeconds * 1e3, 12, 'f', 1)
+               .arg(evaluateSpeedup, 8, 'f', 2).arg(evaluateSpeedup * scale, 10, 'f', 2)
+               .arg(run.searchSeconds * 1e3, 10, 'f', 1)
+               .arg(searchSpeedup, 8, 'f', 2).arg(searchSpeedup * scale, 10, 'f', 2).arg(run.nodes, 12)
+               .arg(run.statistics.jobs, 10).arg(run.statistics.steals, 8) << Qt::endl;
+    }
+    if (parser.isSet("trace") && !writeTrace(parser.value("trace"), traces, runs)) {
+        err << "Could not write the trace to " << parser.value("trace") << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
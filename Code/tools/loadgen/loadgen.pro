@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Load generator for connect4_server
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = connect4_loadgen
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../server
+
+SOURCES += main.cpp
+
+HEADERS += ../server/protocol.h
+
+include(../../engine.pri)
@@ -0,0 +1,249 @@
+#include "board.h"
+#include "protocol.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QQueue>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+/**
+ * Load generator for connect4_server.
+ *
+ * Opens a number of connections that each play a number of sessions at the
+ * same time, with random legal moves. A finished game is reset and played
+ * again. Reports moves per second and the request latency percentiles:
+ *
+ *   connect4_loadgen --connections 8 --sessions 500 --moves 1000000
+ */
+
+struct Totals
+{
+    qint64 target = 0;      // Number of moves to send in total
+    qint64 sent = 0;
+    qint64 errors = 0;
+    int activeConnections = 0;
+    QVector<qint64> latencies; // Nanoseconds, one per answered request
+    QElapsedTimer clock;
+};
+
+class LoadConnection
+{
+public:
+    LoadConnection(const QString &serverName, int sessionCount, unsigned seed, Totals &totals)
+        : sessions(sessionCount), generator(seed), totals(totals)
+    {
+        QObject::connect(&socket, &QLocalSocket::connected, [this]() { start(); });
+        QObject::connect(&socket, &QLocalSocket::readyRead, [this]() { handleResponses(); });
+        QObject::connect(&socket, &QLocalSocket::errorOccurred, [this]() { fail(); });
+        totals.activeConnections++;
+        socket.connectToServer(serverName);
+    }
+
+private:
+    struct Session
+    {
+        quint32 handle = 0;
+        BitBoard game;
+    };
+
+    struct Request
+    {
+        int session;
+        qint64 sentAt;
+    };
+
+    void start()
+    {
+        for (int i = 0; i < sessions.size(); i++) {
+            send(i, Protocol::NEW_GAME, 0);
+        }
+        flush();
+    }
+
+    void send(int session, quint8 type, quint8 column)
+    {
+        Protocol::Message message;
+        message.type = type;
+        message.column = column;
+        message.session = sessions[session].handle;
+
+        int offset = output.size();
+        output.resize(offset + Protocol::MessageSize);
+        Protocol::encode(message, output.data() + offset);
+        inFlight.enqueue({session, totals.clock.nsecsElapsed()});
+    }
+
+    void flush()
+    {
+        if (!output.isEmpty()) {
+            socket.write(output);
+            output.clear();
+        }
+        if (inFlight.isEmpty()) {
+            // Nothing left to wait for.
+            socket.disconnectFromServer();
+            finish();
+        }
+    }
+
+    // Sends the next move of a session, unless enough moves were sent.
+    void sendMove(int session)
+    {
+        if (totals.sent >= totals.target) return;
+
+        BitBoard &game = sessions[session].game;
+        int moves[BitBoard::Columns];
+        int moveCount = 0;
+        for (int column = 0; column < BitBoard::Columns; column++) {
+            if (game.canPlay(column)) moves[moveCount++] = column;
+        }
+
+        int column = moves[std::uniform_int_distribution<int>(0, moveCount - 1)(generator)];
+        send(session, Protocol::MOVE, quint8(column));
+        totals.sent++;
+    }
+
+    void handleResponses()
+    {
+        input.append(socket.readAll());
+        int count = input.size() / Protocol::MessageSize;
+        qint64 now = totals.clock.nsecsElapsed();
+
+        for (int i = 0; i < count; i++) {
+            Protocol::Message message = Protocol::decode(input.constData() + i * Protocol::MessageSize);
+            Request request = inFlight.dequeue();
+            Session &session = sessions[request.session];
+            totals.latencies.append(now - request.sentAt);
+
+            if (message.status != Protocol::OK) {
+                totals.errors++;
+                continue;
+            }
+
+            switch (message.type) {
+                case Protocol::NEW_GAME:
+                    session.handle = message.session;
+                    sendMove(request.session);
+                    break;
+                case Protocol::MOVE:
+                    session.game.play(message.column);
+                    if (session.game.isGameOver()) {
+                        send(request.session, Protocol::RESET, 0);
+                    } else {
+                        sendMove(request.session);
+                    }
+                    break;
+                case Protocol::RESET:
+                    session.game.clear();
+                    sendMove(request.session);
+                    break;
+            }
+        }
+        input.remove(0, count * Protocol::MessageSize);
+        flush();
+    }
+
+    void fail()
+    {
+        QTextStream(stderr) << "Connection failed: " << socket.errorString() << Qt::endl;
+        totals.errors++;
+        finish();
+    }
+
+    void finish()
+    {
+        if (finished) return;
+        finished = true;
+
+        // Queued, connecting can fail before the event loop runs.
+        if (--totals.activeConnections == 0) {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+        }
+    }
+
+    QLocalSocket socket;
+    QVector<Session> sessions;
+    QQueue<Request> inFlight;
+    QByteArray input, output;
+    std::mt19937 generator;
+    Totals &totals;
+    bool finished = false;
+};
+
+static double percentile(const QVector<qint64> &sorted, double fraction)
+{
+    if (sorted.isEmpty()) return 0;
+    int index = qMin(sorted.size() - 1, int(fraction * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Plays random games against connect4_server and measures it.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"name", "Name of the server socket.", "name", Protocol::DefaultServerName},
+        {"connections", "Number of connections.", "n", "4"},
+        {"sessions", "Number of concurrent games per connection.", "n", "250"},
+        {"moves", "Total number of moves to play.", "n", "1000000"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    if (!checkInteger(parser, "connections", 1, err) || !checkInteger(parser, "sessions", 1, err) ||
+        !checkInteger(parser, "moves", 1, err)) {
+        return 1;
+    }
+
+    Totals totals;
+    totals.target = parser.value("moves").toLongLong();
+    totals.latencies.reserve(int(qMin<qint64>(totals.target * 2, 1 << 26)));
+    totals.clock.start();
+
+    int connectionCount = parser.value("connections").toInt();
+    std::vector<std::unique_ptr<LoadConnection>> connections;
+    for (int i = 0; i < connectionCount; i++) {
+        connections.emplace_back(new LoadConnection(parser.value("name"), parser.value("sessions").toInt(), i + 1, totals));
+    }
+
+    app.exec();
+
+    double seconds = totals.clock.nsecsElapsed() / 1e9;
+    std::sort(totals.latencies.begin(), totals.latencies.end());
+
+    QTextStream out(stdout);
+    out << "moves       " << totals.sent << Qt::endl;
+    out << "requests    " << totals.latencies.size() << Qt::endl;
+    out << "errors      " << totals.errors << Qt::endl;
+    out << "seconds     " << seconds << Qt::endl;
+    out << "moves/s     " << (seconds > 0 ? totals.sent / seconds : 0) << Qt::endl;
+    out << "p50 latency " << percentile(totals.latencies, 0.50) << " us" << Qt::endl;
+    out << "p99 latency " << percentile(totals.latencies, 0.99) << " us" << Qt::endl;
+
+    return totals.errors > 0 ? 1 : 0;
+}
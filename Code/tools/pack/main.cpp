@@ -0,0 +1,221 @@
+#include "assetbundle.h"
+#include "eventlog.h"
+#include "jobsystem.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/**
+ * Packs the assets of the game into a bundle, see assetbundle.h.
+ *
+ * Every file under models/, textures/ and shaders/ of the source directory
+ * becomes an entry. Images and models are decoded as the game would decode
+ * them, unless --keep-sources stores them as they are. The assets are
+ * packed at the same time, on --jobs threads:
+ *
+ *   connect4_pack build/assets.bundle
+ *   connect4_pack --list build/assets.bundle
+ */
+
+static const char *const Directories[] = {"models", "textures", "shaders"};
+
+static const char *const TypeNames[] = {"file", "image", "mesh"};
+
+struct PackedAsset
+{
+    AssetBundle::Entry entry;
+    QByteArray data;
+};
+
+static quint64 aligned(quint64 offset)
+{
+    return (offset + AssetBundle::Alignment - 1) / AssetBundle::Alignment * AssetBundle::Alignment;
+}
+
+// Runs on any thread, so it does not print the error itself.
+static bool pack(const AssetBundle &source, const QString &name, bool decode, PackedAsset &asset, QString &error)
+{
+    QByteArray utf8 = name.toUtf8();
+    if (utf8.size() >= AssetBundle::NameSize) {
+        error = QString("The name %1 is longer than %2 bytes.").arg(name).arg(AssetBundle::NameSize - 1);
+        return false;
+    }
+    std::memset(&asset.entry, 0, sizeof(asset.entry));
+    std::memcpy(asset.entry.name, utf8.constData(), utf8.size());
+    asset.entry.type = AssetBundle::FILE;
+
+    // Decoded by the same code that reads them without a bundle.
+    if (decode && name.endsWith(".png")) {
+        QImage image = source.image(name);
+        if (image.isNull()) {
+            error = "Could not decode " + name;
+            return false;
+        }
+        asset.entry.type = AssetBundle::IMAGE;
+        asset.entry.width = image.width();
+        asset.entry.height = image.height();
+        for (int y = 0; y < image.height(); y++) {
+            asset.data.append(reinterpret_cast<const char *>(image.constScanLine(y)), image.width() * 4);
+        }
+    } else if (decode && name.endsWith(".obj")) {
+        QVector<float> vertices = source.mesh(name);
+        if (vertices.isEmpty()) {
+            error = "Could not load " + name;
+            return false;
+        }
+        asset.entry.type = AssetBundle::MESH;
+        asset.data = QByteArray(reinterpret_cast<const char *>(vertices.constData()), vertices.size() * sizeof(float));
+    } else {
+        asset.data = source.file(name);
+    }
+    asset.entry.size = asset.data.size();
+    return true;
+}
+
+static bool write(const QString &fileName, std::vector<PackedAsset> &assets, QTextStream &err)
+{
+    AssetBundle::Header header = {AssetBundle::Magic, AssetBundle::Version, quint32(assets.size()), 0};
+
+    quint64 offset = aligned(sizeof(header) + assets.size() * sizeof(AssetBundle::Entry));
+    for (PackedAsset &asset : assets) {
+        asset.entry.offset = offset;
+        offset = aligned(offset + asset.entry.size);
+    }
+
+    // Written to a temporary file first, a running game may have the bundle mapped.
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        err << "Could not write " << fileName << Qt::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const PackedAsset &asset : assets) {
+        file.write(reinterpret_cast<const char *>(&asset.entry), sizeof(asset.entry));
+    }
+    for (const PackedAsset &asset : assets) {
+        file.write(QByteArray(int(asset.entry.offset - file.pos()), 0));
+        file.write(asset.data);
+    }
+    file.write(QByteArray(int(aligned(file.pos()) - file.pos()), 0));
+
+    if (!file.commit()) {
+        err << "Could not write " << fileName << Qt::endl;
+        return false;
+    }
+    return true;
+}
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_pack");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Packs the models, textures and shaders into an asset bundle.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("bundle", "The asset bundle to write.");
+    parser.addOptions({
+        {"source", "Directory with the models, textures and shaders directories.", "directory", ASSET_DIRECTORY},
+        {"keep-sources", "Store the PNG and OBJ files as they are, instead of decoded."},
+        {"list", "List the entries of the bundle instead of packing it."},
+        {"jobs", "Threads that pack the assets, one per core by default.", "n", "0"},
+    });
+    parser.process(app);
+
+    EventLog::setLevel(EventLog::WARNING);
+    EventLog::start();
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (!checkInteger(parser, "jobs", 0, err)) return 1;
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+    QString fileName = parser.positionalArguments().first();
+
+    if (parser.isSet("list")) {
+        AssetBundle bundle;
+        if (!bundle.open(fileName)) {
+            err << "Could not open the asset bundle " << fileName << Qt::endl;
+            return 1;
+        }
+        for (const AssetBundle::Entry &entry : bundle) {
+            out << QString("%1 %2  %3").arg(TypeNames[qMin<quint32>(entry.type, 2)], -5)
+                                       .arg(entry.size, 10).arg(entry.name);
+            if (entry.type == AssetBundle::IMAGE) out << " (" << entry.width << " x " << entry.height << ")";
+            out << Qt::endl;
+        }
+        return 0;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    AssetBundle source;
+    source.openDirectory(parser.value("source"));
+    QDir root(parser.value("source"));
+
+    QStringList names;
+    quint64 sourceBytes = 0;
+    for (const char *directory : Directories) {
+        QDirIterator files(root.filePath(directory), QDir::Files, QDirIterator::Subdirectories);
+        while (files.hasNext()) {
+            names << root.relativeFilePath(files.next());
+            sourceBytes += files.fileInfo().size();
+        }
+    }
+    if (names.isEmpty()) {
+        err << "There are no assets in " << parser.value("source") << Qt::endl;
+        return 1;
+    }
+
+    JobSystem jobs(parser.value("jobs").toInt());
+    std::vector<PackedAsset> assets(names.size());
+    std::vector<QString> errors(names.size());
+    bool decode = !parser.isSet("keep-sources");
+    jobs.parallelFor("pack", 0, names.size(), 1, [&](int i) {
+        pack(source, names[i], decode, assets[i], errors[i]);
+    });
+    // The first error in the order of the files, as if they were packed one by one.
+    for (const QString &error : errors) {
+        if (!error.isEmpty()) {
+            err << error << Qt::endl;
+            return 1;
+        }
+    }
+
+    // The index is searched by name.
+    std::sort(assets.begin(), assets.end(), [](const PackedAsset &a, const PackedAsset &b) {
+        return std::strcmp(a.entry.name, b.entry.name) < 0;
+    });
+    if (!write(fileName, assets, err)) return 1;
+
+    out << "Packed " << assets.size() << " assets, " << sourceBytes / 1024 << " KiB of sources, into "
+        << fileName << ", " << QFileInfo(fileName).size() / 1024 << " KiB, in " << timer.elapsed() << " ms" << Qt::endl;
+    return 0;
+}
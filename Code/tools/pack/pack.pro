@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Packs the models, textures and shaders into
+# the asset bundle the game maps
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = connect4_pack
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../..
+DEFINES += ASSET_DIRECTORY=\\\"$$PWD/../..\\\"
+
+SOURCES += main.cpp \
+    ../../assetbundle.cpp \
+    ../../eventlog.cpp \
+    ../../jobsystem.cpp \
+    ../../model.cpp
+
+HEADERS += ../../assetbundle.h \
+    ../../eventlog.h \
+    ../../jobsystem.h \
+    ../../model.h
+
+# Building the packer packs the assets as well, into assets.bundle next to it,
+# unless scene.pri builds it to pack next to the game instead.
+!no_self_pack: QMAKE_POST_LINK += $$shell_quote($$shell_path($$OUT_PWD/$$TARGET)) $$shell_quote($$shell_path($$OUT_PWD/assets.bundle))
@@ -0,0 +1,172 @@
+#include "connect4.h"
+#include "board.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+
+/**
+ * Perft harness for the game engines.
+ *
+ * Counts every sequence of legal moves up to a depth from a set of
+ * positions. A game that is won or drawn is not continued. The counts
+ * of every engine are checked against known values and against each
+ * other, so a faster engine is always compared to the char array
+ * reference implementation used by the game.
+ *
+ *   connect4_perft --depth 9
+ */
+
+// A position is given by the columns played from the empty board, '1' through '7'.
+struct KnownPosition
+{
+    QByteArray moves;
+    QVector<qint64> counts; // counts[d - 1] is the count at depth d
+};
+
+// The counts from the empty board are OEIS A212693.
+static const KnownPosition knownPositions[] = {
+    {"", {7, 49, 343, 2401, 16807, 117649, 823536, 5673234, 39394572, 268031646}},
+    {"4453", {7, 49, 343, 2317, 16218, 108118, 749587}},
+    {"3443225", {7, 49, 343, 2401, 16685, 115949, 792568}},
+    {"1212343471", {7, 49, 343, 2358, 15989, 108361, 709681}},
+    {"444444333333", {5, 25, 125, 505, 2525, 10345, 50370}},
+};
+
+template <typename Engine>
+static qint64 perft(Engine &game, int depth)
+{
+    if (depth == 0) return 1;
+
+    qint64 count = 0;
+    for (int column = 0; column < Engine::Columns; column++) {
+        if (!game.canPlay(column)) continue;
+
+        if (game.play(column) == Engine::UNFINISHED) {
+            count += perft(game, depth - 1);
+        } else if (depth == 1) {
+            count += 1;
+        }
+        game.undo(column);
+    }
+    return count;
+}
+
+struct PerftResult
+{
+    qint64 count = -1;
+    double seconds = 0;
+};
+
+template <typename Engine>
+static PerftResult runPerft(const QByteArray &moves, int depth)
+{
+    Engine game;
+    for (char move : moves) {
+        game.play(move - '1');
+    }
+
+    PerftResult result;
+    QElapsedTimer timer;
+    timer.start();
+    result.count = perft(game, depth);
+    result.seconds = timer.nsecsElapsed() / 1e9;
+    return result;
+}
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_perft");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Counts and times all move sequences with every game engine.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"depth", "Maximum depth to search.", "d", "8"},
+        {"position", "Only search from this position, given as the columns played.", "moves"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    if (!checkInteger(parser, "depth", 1, err)) return 1;
+
+    int maxDepth = parser.value("depth").toInt();
+
+    QVector<KnownPosition> positions;
+    if (parser.isSet("position")) {
+        QByteArray moves = parser.value("position").toLatin1();
+        positions.append({moves, {}});
+        for (const KnownPosition &known : knownPositions) {
+            if (moves == known.moves) positions.last().counts = known.counts;
+        }
+    } else {
+        for (const KnownPosition &known : knownPositions) {
+            positions.append(known);
+        }
+    }
+
+    QTextStream out(stdout);
+    out << qSetFieldWidth(14) << left << "position" << "depth" << "count"
+        << "reference/s" << "bitboard/s" << "speedup" << qSetFieldWidth(0) << "result" << Qt::endl;
+
+    int failures = 0;
+    for (const KnownPosition &position : positions) {
+        const QByteArray &moves = position.moves;
+        for (char move : moves) {
+            if (move < '1' || move > '0' + Connect4::Columns) {
+                out << "Invalid position: " << moves << Qt::endl;
+                return 1;
+            }
+        }
+
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            PerftResult reference = runPerft<Connect4>(moves, depth);
+            PerftResult bitboard = runPerft<BitBoard>(moves, depth);
+
+            qint64 expected = depth <= position.counts.size() ? position.counts[depth - 1] : -1;
+
+            QString status = "ok";
+            if (bitboard.count != reference.count) {
+                status = "MISMATCH between engines";
+            } else if (expected >= 0 && reference.count != expected) {
+                status = QString("MISMATCH, expected %1").arg(expected);
+            } else if (expected < 0) {
+                status = "ok (no known value)";
+            }
+            if (!status.startsWith("ok")) failures++;
+
+            auto rate = [](const PerftResult &result) {
+                return result.seconds > 0 ? result.count / result.seconds : 0.0;
+            };
+
+            out << qSetFieldWidth(14) << left << (moves.isEmpty() ? QByteArray("start") : moves)
+                << depth << reference.count
+                << qSetRealNumberPrecision(4) << rate(reference) << rate(bitboard)
+                << (bitboard.seconds > 0 ? reference.seconds / bitboard.seconds : 0.0)
+                << qSetFieldWidth(0) << status << Qt::endl;
+        }
+    }
+
+    if (failures > 0) {
+        out << failures << " perft count(s) failed." << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Perft harness comparing the game engines
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = connect4_perft
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../../engine.pri)
@@ -0,0 +1,625 @@
+#include "assetbundle.h"
+#include "boardwall.h"
+#include "eventlog.h"
+#include "framecapture.h"
+#include "game.h"
+#include "gridrenderer.h"
+#include "jobsystem.h"
+#include "scenerenderer.h"
+#include "softwarerenderer.h"
+#include "startupprofile.h"
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLDebugLogger>
+#include <QOpenGLFramebufferObject>
+#include <QTextStream>
+#include <QtMath>
+
+#include <cmath>
+#include <fstream>
+
+/**
+ * Headless renderer.
+ *
+ * Draws a game with the same code as the game window, but into an
+ * offscreen framebuffer, as fast as possible. The moves come from a game
+ * record archive or from the command line, one move every --interval
+ * frames. Reports the frames per second and can write every frame to an
+ * image. Needs no GPU and no display, Mesa's llvmpipe is enough:
+ *
+ *   QT_QPA_PLATFORM=offscreen connect4_render --software --record games.c4r --frames 1000
+ *
+ * With --renderer software it draws with the SoftwareRenderer and needs
+ * no OpenGL at all; --threads 1,2,4,8 measures how it scales. --compare
+ * draws every frame with both renderers and reports how far apart they are.
+ *
+ * With --grid it draws a wall of games played by the computer instead,
+ * while the camera zooms in from the whole wall to a few boards and out.
+ */
+
+// Reads game number index (0 based) from a game record archive.
+static bool readRecord(const QString &fileName, int index, GameRecord &record)
+{
+    std::ifstream file(fileName.toLocal8Bit().constData(), std::ios::binary);
+    GameRecordReader reader(file);
+    for (int i = 0; i <= index; i++) {
+        if (!reader.read(record)) return false;
+    }
+    return true;
+}
+
+// How far the frames of the OpenGL and the software renderer are apart, for --compare.
+struct ImageDifference
+{
+    // A pixel differs if a channel is further apart than this.
+    static const int Tolerance = 16;
+
+    double sum = 0;
+    int maximum = 0;
+    qint64 pixels = 0;
+    qint64 differing = 0;
+
+    void add(const QImage &a, const QImage &b)
+    {
+        // Both are 32 bits per pixel, compared as stored: the OpenGL frame
+        // has an alpha of 0 where it was only cleared.
+        for (int y = 0; y < qMin(a.height(), b.height()); y++) {
+            const QRgb *rowA = reinterpret_cast<const QRgb *>(a.constScanLine(y));
+            const QRgb *rowB = reinterpret_cast<const QRgb *>(b.constScanLine(y));
+            for (int x = 0; x < qMin(a.width(), b.width()); x++) {
+                int red = qAbs(qRed(rowA[x]) - qRed(rowB[x]));
+                int green = qAbs(qGreen(rowA[x]) - qGreen(rowB[x]));
+                int blue = qAbs(qBlue(rowA[x]) - qBlue(rowB[x]));
+                int largest = qMax(red, qMax(green, blue));
+
+                sum += red + green + blue;
+                maximum = qMax(maximum, largest);
+                pixels++;
+                if (largest > Tolerance) differing++;
+            }
+        }
+    }
+
+    double mean() const { return pixels > 0 ? sum / (3 * pixels) : 0; }
+    double differingPercent() const { return pixels > 0 ? 100.0 * differing / pixels : 0; }
+};
+
+// Plays the moves with the software renderer, for --renderer software.
+// Every thread count in --threads is a run of its own.
+static int renderSoftware(const QCommandLineParser &parser, const std::vector<uint8_t> &moves,
+                          QVector3D rotation, SceneRenderer::ShadingMode shading,
+                          QTextStream &out, QTextStream &err)
+{
+    int frames = parser.value("frames").toInt();
+    int interval = qMax(1, parser.value("interval").toInt());
+    double frameTime = parser.value("frame-time").toDouble() / 1000;
+    int width = parser.value("width").toInt();
+    int height = parser.value("height").toInt();
+    QString dumpDirectory = parser.value("dump");
+
+    std::vector<int> threadCounts;
+    for (const QString &count : parser.value("threads").split(',')) {
+        threadCounts.push_back(count.toInt());
+    }
+
+    SoftwareRenderer renderer;
+    renderer.initialize();
+    renderer.resize(width, height);
+    renderer.setRotation(rotation);
+    renderer.setShadingMode(shading);
+
+    out << "renderer    software" << Qt::endl;
+    if (threadCounts.size() > 1) {
+        out << "threads  frames/s  geometry ms  raster ms  Mtriangles/s  Mfragments/s" << Qt::endl;
+    }
+
+    for (int threads : threadCounts) {
+        // A job system of its own, with as many threads as parts. The workers
+        // of the application's sleep meanwhile.
+        JobSystem jobs(threads);
+        renderer.setJobSystem(&jobs);
+        renderer.setThreadCount(threads);
+
+        Game game;
+        game.clear();
+        game.setBounce(parser.isSet("bounce"));
+
+        double geometry = 0, raster = 0, triangles = 0, fragments = 0;
+        QElapsedTimer timer;
+        timer.start();
+
+        size_t nextMove = 0;
+        for (int frameNumber = 0; frameNumber < frames; frameNumber++) {
+            if (frameNumber % interval == 0 && nextMove < moves.size()) {
+                game.dropDisk(moves[nextMove++] + 1);
+            }
+            game.advance(frameTime);
+            renderer.render(game.scene());
+
+            const SoftwareRenderer::Statistics &statistics = renderer.statistics();
+            geometry += statistics.geometryMilliseconds;
+            raster += statistics.rasterMilliseconds;
+            triangles += statistics.rasterized;
+            fragments += statistics.fragments;
+
+            if (!dumpDirectory.isEmpty()) {
+                if (!renderer.image().save(QString("%1/frame%2.png").arg(dumpDirectory).arg(frameNumber, 5, 10, QChar('0')))) {
+                    err << "Could not write to " << dumpDirectory << Qt::endl;
+                    return 1;
+                }
+            }
+        }
+        double seconds = timer.nsecsElapsed() / 1e9;
+        int count = qMax(1, frames);
+
+        if (threadCounts.size() > 1) {
+            out << qSetFieldWidth(7) << renderer.threadCount() << qSetFieldWidth(0) << "  "
+                << qSetFieldWidth(8) << (seconds > 0 ? frames / seconds : 0) << qSetFieldWidth(0) << "  "
+                << qSetFieldWidth(11) << geometry / count << qSetFieldWidth(0) << "  "
+                << qSetFieldWidth(9) << raster / count << qSetFieldWidth(0) << "  "
+                << qSetFieldWidth(12) << (seconds > 0 ? triangles / seconds / 1e6 : 0) << qSetFieldWidth(0) << "  "
+                << qSetFieldWidth(12) << (seconds > 0 ? fragments / seconds / 1e6 : 0) << qSetFieldWidth(0) << Qt::endl;
+            continue;
+        }
+
+        out << "threads     " << renderer.threadCount() << Qt::endl;
+        out << "frames      " << frames << Qt::endl;
+        out << "seconds     " << seconds << Qt::endl;
+        if (seconds > 0) {
+            out << "frames/s    " << frames / seconds << Qt::endl;
+            out << "triangles/s " << triangles / seconds << Qt::endl;
+            out << "fragments/s " << fragments / seconds << Qt::endl;
+        }
+        out << "geometry    " << geometry / count << " ms" << Qt::endl;
+        out << "raster      " << raster / count << " ms" << Qt::endl;
+    }
+    return 0;
+}
+
+// Writes the profile of a renderer to <profile>.json and <profile>.trace.json.
+static void writeProfile(const FrameProfiler &profiler, const QString &profile, QTextStream &out, QTextStream &err)
+{
+    out << profiler.overlayText();
+    if (!profiler.writeSummary(profile + ".json") || !profiler.writeTrace(profile + ".trace.json")) {
+        err << "Could not write the profile to " << profile << Qt::endl;
+    }
+}
+
+// The --grid benchmark.
+static void renderGrid(int boardCount, int frames, double frameTime, int width, int height,
+                       const QString &profile, QTextStream &out, QTextStream &err)
+{
+    // Every move of every board would be logged.
+    if (EventLog::level() == EventLog::INFO) EventLog::setLevel(EventLog::WARNING);
+
+    BoardWall wall(boardCount);
+    GridRenderer renderer;
+    renderer.initialize();
+    renderer.resize(width, height);
+    renderer.profiler().setEnabled(!profile.isEmpty());
+
+    double visibleBoards = 0, lowDetailBoards = 0, disks = 0, drawCalls = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int frameNumber = 0; frameNumber < frames; frameNumber++) {
+        // Zooms from the whole wall to a few boards and back, drifting sideways.
+        double phase = 2 * M_PI * frameNumber / qMax(1, frames - 1);
+        float zoom = 1 + 3.5f * static_cast<float>(1 - std::cos(phase));
+        renderer.setCamera(QVector2D(std::sin(phase), std::sin(2 * phase) / 2) * 10, zoom);
+
+        wall.advance(frameTime);
+        renderer.render(wall);
+
+        const GridRenderer::Statistics &statistics = renderer.statistics();
+        visibleBoards += statistics.visibleBoards;
+        lowDetailBoards += statistics.lowDetailBoards;
+        disks += statistics.disks;
+        drawCalls += statistics.drawCalls;
+    }
+    QOpenGLContext::currentContext()->functions()->glFinish();
+
+    double seconds = timer.nsecsElapsed() / 1e9;
+    int count = qMax(1, frames);
+
+    out << "boards      " << boardCount << Qt::endl;
+    out << "frames      " << frames << Qt::endl;
+    out << "seconds     " << seconds << Qt::endl;
+    if (seconds > 0) {
+        out << "frames/s    " << frames / seconds << Qt::endl;
+    }
+    out << "in view     " << visibleBoards / count << " boards, " << lowDetailBoards / count << " low detail" << Qt::endl;
+    out << "disks       " << disks / count << Qt::endl;
+    out << "draw calls  " << drawCalls / count << Qt::endl;
+
+    if (!profile.isEmpty()) {
+        writeProfile(renderer.profiler(), profile, out, err);
+    }
+    renderer.destroy();
+}
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    StartupProfile startup;
+    startup.begin("application");
+
+    // The software rasterizer and the shader cache have to be chosen before the application starts.
+    for (int i = 1; i < argc; i++) {
+        if (qstrcmp(argv[i], "--software") == 0) {
+            qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+            QCoreApplication::setAttribute(Qt::AA_UseSoftwareOpenGL);
+        } else if (qstrcmp(argv[i], "--no-shader-cache") == 0) {
+            QCoreApplication::setAttribute(Qt::AA_DisableShaderDiskCache);
+        }
+    }
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_render");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders a game without a window and measures the frame rate.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"record", "Game record archive to take the moves from.", "file"},
+        {"game", "Index of the game in the archive.", "n", "0"},
+        {"moves", "Columns to play (1 indexed), e.g. 4453. Used without --record.", "moves", "4453"},
+        {"frames", "Number of frames to render.", "n", "600"},
+        {"interval", "Number of frames between two moves.", "n", "30"},
+        {"frame-time", "Time the animation moves on every frame.", "ms", "16.667"},
+        {"bounce", "Let the disks bounce when they land."},
+        {"width", "Width of the image.", "pixels", "1280"},
+        {"height", "Height of the image.", "pixels", "720"},
+        {"rotation", "Camera rotation in degrees around x, y and z.", "x,y,z", "0,0,0"},
+        {"shading", "phong, normal, gouraud or baked.", "mode", "phong"},
+        {"dump", "Write every frame to this directory as PNG.", "directory"},
+        {"capture", "Write every frame to this Y4M video, or to this directory as PNGs if it does not end in .y4m, read back without waiting for the GPU.", "file"},
+        {"software", "Render with Mesa's software rasterizer."},
+        {"renderer", "opengl, or software to draw with the tiled rasterizer of this project, without OpenGL.", "renderer", "opengl"},
+        {"threads", "Threads of the software renderer, 0 for one per core. A list like 1,2,4 measures each.", "n", "0"},
+        {"compare", "Also draw every frame with the software renderer and report how far the images are apart. Use without shadows, dynamic resolution and the baked mode."},
+        {"compare-limit", "With --compare, fail if more than this percentage of the pixels differ.", "percent", "2"},
+        {"shadows", "Shadows: off, uncached or cached.", "mode", "off"},
+        {"frame-budget", "Lower the resolution of the scene to keep the GPU time of a frame under this many milliseconds.", "ms"},
+        {"grid", "Draw this many games played by the computer at once, while the camera zooms in and out.", "boards"},
+        {"pick", "Afterwards, cast this many rays at the board over a grid of the frame and time them.", "rays"},
+        {"incremental", "Draw the board and the table once, and after that only the disks."},
+        {"no-shader-cache", "Build the shader programs from source instead of loading them from the disk cache."},
+        {"startup-profile", "Write how long every phase of the start up took to this file as JSON.", "file"},
+        {"startup-baseline", "Fail if a phase of the start up was slower than in this report.", "file"},
+        {"startup-threshold", "Factor a phase may be slower than in the baseline.", "factor", "1.5"},
+        {"profile", "Time the sections of every frame, write the percentiles to <file>.json and a Chrome trace to <file>.trace.json.", "file"},
+        {"assets", "Asset bundle to load the models, textures and shaders from, instead of assets.bundle next to the program.", "file"},
+        {"jobs", "Threads of the job system that loads the assets and plays the grid, one per core by default.", "n", "0"},
+        {"diagnostics", "warning, info, debug for an OpenGL debug context with its messages logged asynchronously, or trace to log them synchronously.", "level", "info"},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    for (const char *option : {"frames", "interval", "width", "height"}) {
+        if (!checkInteger(parser, option, 1, err)) return 1;
+    }
+    if (!checkInteger(parser, "game", 0, err) || !checkInteger(parser, "threads", 0, err) ||
+        !checkInteger(parser, "jobs", 0, err) || (parser.isSet("grid") && !checkInteger(parser, "grid", 1, err)) ||
+        (parser.isSet("pick") && !checkInteger(parser, "pick", 1, err))) {
+        return 1;
+    }
+
+    EventLog::Level diagnostics;
+    if (!EventLog::parseLevel(parser.value("diagnostics"), diagnostics)) {
+        err << "Unknown diagnostics level: " << parser.value("diagnostics") << Qt::endl;
+        return 1;
+    }
+    EventLog::setLevel(diagnostics);
+    EventLog::start();
+
+    if (parser.isSet("assets") && !AssetBundle::setShared(parser.value("assets"))) {
+        err << "Could not open the asset bundle " << parser.value("assets") << Qt::endl;
+        return 1;
+    }
+    JobSystem jobs(parser.value("jobs").toInt());
+
+    // The moves to play, 0 indexed.
+    std::vector<uint8_t> moves;
+    if (parser.isSet("record")) {
+        GameRecord record;
+        if (!readRecord(parser.value("record"), parser.value("game").toInt(), record)) {
+            err << "Could not read game " << parser.value("game") << " from " << parser.value("record") << Qt::endl;
+            return 1;
+        }
+        if (record.columns != GameBoard::Columns || record.rows != GameBoard::Rows || record.inARow != GameBoard::InARow) {
+            err << "The game was played on a board that is not drawn." << Qt::endl;
+            return 1;
+        }
+        moves = record.moves;
+    } else {
+        for (QChar move : parser.value("moves")) {
+            int column = move.digitValue();
+            if (column < 1 || column > GameBoard::Columns) {
+                err << "--moves must be columns from 1 to " << GameBoard::Columns << ", not " << parser.value("moves") << Qt::endl;
+                return 1;
+            }
+            moves.push_back(uint8_t(column - 1));
+        }
+    }
+
+    QStringList rotation = parser.value("rotation").split(',');
+    if (rotation.size() != 3) {
+        err << "The rotation needs three angles." << Qt::endl;
+        return 1;
+    }
+    QVector3D cameraRotation(rotation[0].toFloat(), rotation[1].toFloat(), rotation[2].toFloat());
+
+    SceneRenderer::ShadingMode shading;
+    if (parser.value("shading") == "phong") {
+        shading = SceneRenderer::PHONG;
+    } else if (parser.value("shading") == "normal") {
+        shading = SceneRenderer::NORMAL;
+    } else if (parser.value("shading") == "gouraud") {
+        shading = SceneRenderer::GOURAUD;
+    } else if (parser.value("shading") == "baked") {
+        shading = SceneRenderer::BAKED;
+    } else {
+        err << "Unknown shading mode: " << parser.value("shading") << Qt::endl;
+        return 1;
+    }
+
+    SceneRenderer::ShadowMode shadows;
+    if (parser.value("shadows") == "off") {
+        shadows = SceneRenderer::SHADOWS_OFF;
+    } else if (parser.value("shadows") == "uncached") {
+        shadows = SceneRenderer::SHADOWS_UNCACHED;
+    } else if (parser.value("shadows") == "cached") {
+        shadows = SceneRenderer::SHADOWS_CACHED;
+    } else {
+        err << "Unknown shadow mode: " << parser.value("shadows") << Qt::endl;
+        return 1;
+    }
+
+    float frameBudget = 0;
+    if (parser.isSet("frame-budget")) {
+        bool ok = false;
+        frameBudget = parser.value("frame-budget").toFloat(&ok);
+        if (!ok || !(frameBudget > 0)) {
+            err << "--frame-budget must be a number of milliseconds above 0, not " << parser.value("frame-budget") << Qt::endl;
+            return 1;
+        }
+    }
+
+    int frames = parser.value("frames").toInt();
+    int interval = qMax(1, parser.value("interval").toInt());
+    // Fixed, so the same frames are drawn however fast they are drawn.
+    double frameTime = parser.value("frame-time").toDouble() / 1000;
+    int width = parser.value("width").toInt();
+    int height = parser.value("height").toInt();
+
+    QString dumpDirectory = parser.value("dump");
+    if (!dumpDirectory.isEmpty() && !QDir().mkpath(dumpDirectory)) {
+        err << "Could not create " << dumpDirectory << Qt::endl;
+        return 1;
+    }
+
+    if (parser.value("renderer") == "software") {
+        return renderSoftware(parser, moves, cameraRotation, shading, out, err);
+    } else if (parser.value("renderer") != "opengl") {
+        err << "Unknown renderer: " << parser.value("renderer") << Qt::endl;
+        return 1;
+    }
+
+    // Same context as the game window asks for.
+    QSurfaceFormat format;
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setVersion(3, 3);
+    format.setDepthBufferSize(24);
+    if (EventLog::wantsDebugContext()) {
+        format.setOption(QSurfaceFormat::DebugContext);
+    }
+
+    startup.begin("context");
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create()) {
+        err << "Could not create an OpenGL 3.3 context." << Qt::endl;
+        return 1;
+    }
+
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!context.makeCurrent(&surface)) {
+        err << "Could not make the OpenGL context current." << Qt::endl;
+        return 1;
+    }
+
+    QOpenGLDebugLogger debugLogger;
+    if (context.format().testOption(QSurfaceFormat::DebugContext) && debugLogger.initialize()) {
+        QObject::connect(&debugLogger, &QOpenGLDebugLogger::messageLogged, &EventLog::logOpenGLMessage);
+        debugLogger.startLogging(EventLog::openGLLoggingMode());
+    }
+
+    startup.begin("framebuffer");
+    QOpenGLFramebufferObject framebuffer(width, height, QOpenGLFramebufferObject::CombinedDepthStencil);
+
+    out << "OpenGL      " << reinterpret_cast<const char*>(context.functions()->glGetString(GL_RENDERER)) << Qt::endl;
+
+    if (parser.isSet("grid")) {
+        framebuffer.bind();
+        context.functions()->glViewport(0, 0, width, height);
+        renderGrid(qMax(1, parser.value("grid").toInt()), frames, frameTime, width, height,
+                   parser.value("profile"), out, err);
+        framebuffer.release();
+        debugLogger.stopLogging();
+        context.doneCurrent();
+        return 0;
+    }
+
+    SceneRenderer renderer;
+    renderer.setStartupProfile(&startup);
+    renderer.initialize();
+    // Bound after initialize(), whatever it sets up cannot leave another framebuffer bound.
+    framebuffer.bind();
+    context.functions()->glViewport(0, 0, width, height);
+    renderer.resize(width, height);
+    renderer.setRotation(cameraRotation);
+    renderer.setShadingMode(shading);
+    renderer.setIncrementalRendering(parser.isSet("incremental"));
+    renderer.setShadowMode(shadows);
+    if (parser.isSet("frame-budget")) {
+        renderer.setDynamicResolution(true, frameBudget);
+    }
+    renderer.profiler().setEnabled(parser.isSet("profile"));
+    if (shading == SceneRenderer::BAKED) {
+        // Every frame that is measured has to use the baked light.
+        startup.begin("baking");
+        renderer.finishBaking();
+    }
+
+    FrameCapture capture;
+    if (parser.isSet("capture")) {
+        // Every frame is written, the renderer waits for the encoder when it has to.
+        capture.setDropFrames(false);
+        if (!capture.start(parser.value("capture"), QSize(width, height))) {
+            err << "Could not write to " << parser.value("capture") << Qt::endl;
+            return 1;
+        }
+    }
+
+    SoftwareRenderer software;
+    ImageDifference difference;
+    bool compare = parser.isSet("compare");
+    if (compare) {
+        software.initialize();
+        software.resize(width, height);
+        software.setRotation(cameraRotation);
+        software.setShadingMode(shading);
+    }
+
+    Game game;
+    game.clear();
+    game.setBounce(parser.isSet("bounce"));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    size_t nextMove = 0;
+    for (int frameNumber = 0; frameNumber < frames; frameNumber++) {
+        if (frameNumber % interval == 0 && nextMove < moves.size()) {
+            game.dropDisk(moves[nextMove++] + 1);
+        }
+        game.advance(frameTime);
+
+        if (frameNumber == 0) startup.begin("first frame");
+
+        renderer.render(game.scene());
+        capture.captureFrame();
+
+        if (frameNumber == 0) {
+            context.functions()->glFinish();
+            startup.end();
+        }
+
+        if (!dumpDirectory.isEmpty()) {
+            framebuffer.toImage().save(QString("%1/frame%2.png").arg(dumpDirectory).arg(frameNumber, 5, 10, QChar('0')));
+        }
+
+        if (compare) {
+            software.render(game.scene());
+            difference.add(framebuffer.toImage(), software.image());
+            if (!dumpDirectory.isEmpty()) {
+                software.image().save(QString("%1/software%2.png").arg(dumpDirectory).arg(frameNumber, 5, 10, QChar('0')));
+            }
+        }
+    }
+    // Wait until the last frame is drawn, and written.
+    capture.stop();
+    context.functions()->glFinish();
+
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    out << "frames      " << frames << Qt::endl;
+    out << "seconds     " << seconds << Qt::endl;
+    if (seconds > 0) {
+        out << "frames/s    " << frames / seconds << Qt::endl;
+    }
+    if (parser.isSet("capture")) {
+        out << "captured    " << capture.capturedFrames() << " frames, " << capture.droppedFrames() << " dropped" << Qt::endl;
+    }
+    bool comparePassed = true;
+    if (compare) {
+        // Edges and the texture lookups at a distance differ a little.
+        out << "difference  mean " << difference.mean() << ", max " << difference.maximum << ", "
+            << difference.differingPercent() << "% of the pixels off by more than " << ImageDifference::Tolerance << Qt::endl;
+        comparePassed = difference.differingPercent() <= parser.value("compare-limit").toDouble();
+        if (!comparePassed) {
+            err << "The software renderer differs from OpenGL by more than " << parser.value("compare-limit") << "%" << Qt::endl;
+        }
+    }
+    if (renderer.isDynamicResolution()) {
+        out << "scale       " << renderer.renderScale() << Qt::endl;
+    }
+
+    if (parser.isSet("pick")) {
+        // Like moving the mouse all over the window.
+        int rays = qMax(1, parser.value("pick").toInt());
+        int side = qMax(1, qRound(std::sqrt(rays)));
+        int hits = 0;
+
+        QElapsedTimer pickTimer;
+        pickTimer.start();
+        for (int i = 0; i < rays; i++) {
+            QPointF position((i % side + 0.5) * width / side, (i / side % side + 0.5) * height / side);
+            QVector3D hit;
+            if (renderer.pickBoard(position, QSize(width, height), hit)) hits++;
+        }
+        double microseconds = pickTimer.nsecsElapsed() / 1e3 / rays;
+
+        out << "pick        " << microseconds << " us per ray, " << hits << " of " << rays << " hit the board" << Qt::endl;
+    }
+
+    if (parser.isSet("profile")) {
+        writeProfile(renderer.profiler(), parser.value("profile"), out, err);
+    }
+
+    bool startupPassed = true;
+    if (parser.isSet("startup-profile")) {
+        QFile report(parser.value("startup-profile"));
+        if (!report.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+            report.write(QJsonDocument(startup.toJson()).toJson()) < 0) {
+            err << "Could not write the start up profile to " << parser.value("startup-profile") << Qt::endl;
+        }
+    }
+    if (parser.isSet("startup-baseline")) {
+        startupPassed = StartupProfile::check(startup, parser.value("startup-baseline"),
+                                              parser.value("startup-threshold").toDouble());
+    }
+    out << "start up    " << startup.totalMilliseconds() << " ms" << Qt::endl;
+
+    framebuffer.release();
+    renderer.destroy();
+    debugLogger.stopLogging();
+    context.doneCurrent();
+
+    return startupPassed && comparePassed ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Renders games without a window, for benchmarks
+# and for hosts without a display
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = connect4_render
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../../scene.pri)
+include(../../engine.pri)
@@ -0,0 +1,189 @@
+#include "board.h"
+#include "agents.h"
+#include "gamerecord.h"
+#include "jobsystem.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <fstream>
+
+/**
+ * Replays game record archives.
+ *
+ * Streams every record from the archives, plays it on the engine of its
+ * board variant and checks that all moves are legal and that the recorded
+ * result is correct. Optionally asks a computer player for its move in
+ * every position, to see how often it agrees with the moves played:
+ *
+ *   connect4_replay games.c4r --analyse alphabeta:4
+ */
+
+struct ReplayStats
+{
+    qint64 games = 0;
+    qint64 moves = 0;
+    qint64 invalid = 0;
+    qint64 results[4] = {0, 0, 0, 0}; // Indexed by GameRecord::Result
+    qint64 analysed = 0;
+    qint64 agreed = 0;
+};
+
+template <typename Game>
+class Replayer
+{
+public:
+    Replayer(const std::string &analyse)
+        : analyst(analyse.empty() ? nullptr : createAgent<Game>(analyse, 1))
+    {    }
+
+    static bool matches(const GameRecord &record)
+    {
+        return record.columns == Game::Columns && record.rows == Game::Rows && record.inARow == Game::InARow;
+    }
+
+    // Returns false if the record is not a valid game.
+    bool replay(const GameRecord &record, ReplayStats &stats)
+    {
+        Game game;
+        for (uint8_t column : record.moves) {
+            if (!game.canPlay(column)) return false;
+
+            if (analyst) {
+                stats.analysed++;
+                if (analyst->chooseMove(game) == column) stats.agreed++;
+            }
+            game.play(column);
+        }
+
+        uint8_t result = GameRecord::UNFINISHED;
+        if (game.state() == Game::WON) {
+            result = game.moveCount() % 2 ? GameRecord::FIRST_WON : GameRecord::SECOND_WON;
+        } else if (game.state() == Game::DRAW) {
+            result = GameRecord::DRAW;
+        }
+        return result == record.result;
+    }
+
+private:
+    std::unique_ptr<Agent<Game>> analyst;
+};
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays and checks game record archives.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("archives", "Game record archives to replay.", "archives...");
+    parser.addOptions({
+        {"analyse", "Compare every move with the choice of this player, e.g. alphabeta:4.", "agent"},
+        {"threads", "Threads the analysis searches on, 0 for one per core.", "n", "0"},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (!checkInteger(parser, "threads", 0, err)) return 1;
+
+    std::string analyse = parser.value("analyse").toStdString();
+    if (!analyse.empty() && !createAgent<BitBoard>(analyse, 0)) {
+        err << "Unknown agent: " << parser.value("analyse") << Qt::endl;
+        return 1;
+    }
+
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    JobSystem jobs(parser.value("threads").toInt());
+
+    Replayer<Board<7, 6, 4>> standard(analyse);
+    Replayer<Board<8, 7, 4>> large(analyse);
+    Replayer<Board<9, 7, 4>> larger(analyse);
+    Replayer<Board<9, 6, 5>> fiveInARow(analyse);
+
+    ReplayStats stats;
+    qint64 unsupported = 0;
+    qint64 bytes = 0;
+    bool failed = false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    GameRecord record;
+    for (const QString &fileName : parser.positionalArguments()) {
+        std::ifstream file(fileName.toLocal8Bit().constData(), std::ios::binary);
+        GameRecordReader reader(file);
+
+        while (reader.read(record)) {
+            bool valid;
+            if (standard.matches(record)) {
+                valid = standard.replay(record, stats);
+            } else if (large.matches(record)) {
+                valid = large.replay(record, stats);
+            } else if (larger.matches(record)) {
+                valid = larger.replay(record, stats);
+            } else if (fiveInARow.matches(record)) {
+                valid = fiveInARow.replay(record, stats);
+            } else {
+                unsupported++;
+                continue;
+            }
+
+            stats.games++;
+            stats.moves += record.moves.size();
+            stats.results[record.result]++;
+            if (!valid) {
+                err << fileName << ": game " << stats.games << " is not valid" << Qt::endl;
+                stats.invalid++;
+            }
+        }
+
+        if (reader.hasError()) {
+            err << fileName << ": not a game record archive or truncated" << Qt::endl;
+            failed = true;
+        }
+        bytes += reader.bytesRead();
+    }
+
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    out << "games       " << stats.games << Qt::endl;
+    out << "moves       " << stats.moves << Qt::endl;
+    out << "first won   " << stats.results[GameRecord::FIRST_WON] << Qt::endl;
+    out << "second won  " << stats.results[GameRecord::SECOND_WON] << Qt::endl;
+    out << "draws       " << stats.results[GameRecord::DRAW] << Qt::endl;
+    out << "unfinished  " << stats.results[GameRecord::UNFINISHED] << Qt::endl;
+    out << "invalid     " << stats.invalid << Qt::endl;
+    out << "unsupported " << unsupported << Qt::endl;
+    if (stats.analysed > 0) {
+        out << "agreement   " << 100.0 * stats.agreed / stats.analysed << " %" << Qt::endl;
+    }
+    out << "seconds     " << seconds << Qt::endl;
+    if (seconds > 0) {
+        out << "games/s     " << stats.games / seconds << Qt::endl;
+        out << "moves/s     " << stats.moves / seconds << Qt::endl;
+        out << "MB/s        " << bytes / seconds / 1e6 << Qt::endl;
+    }
+
+    return failed || stats.invalid > 0 ? 1 : 0;
+}
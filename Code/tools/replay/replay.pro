@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Replays and checks game record archives
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = connect4_replay
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../../engine.pri)
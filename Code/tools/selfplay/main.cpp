@@ -0,0 +1,280 @@
+#include "board.h"
+#include "agents.h"
+#include "gamerecord.h"
+#include "jobsystem.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QVector>
+
+#include <fstream>
+#include <random>
+
+/**
+ * Headless self-play tournament runner.
+ *
+ * Plays a number of games between two computer players on the job system
+ * and reports every game plus the overall throughput, for example:
+ *
+ *   connect4_selfplay --games 1000 --first alphabeta:6 --second heuristic --format csv
+ */
+
+struct Settings
+{
+    QString first = "heuristic";
+    QString second = "random";
+    int games = 100;
+    int openingMoves = 0;
+    unsigned seed = 1;
+};
+
+struct GameResult
+{
+    int winner = 0;     // 0 for a draw, 1 for the first and 2 for the second player
+    int moves = 0;
+    qint64 nanoseconds = 0;
+    QByteArray moveList; // The columns played, starting at '1'
+};
+
+// Plays one game. Each game gets its own agents and seeds, so the results
+// do not depend on the number of threads.
+template <typename Game>
+static void playGame(const Settings &settings, int index, GameResult &result)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    unsigned seed = settings.seed + 2 * index;
+    std::unique_ptr<Agent<Game>> players[2] = {
+        createAgent<Game>(settings.first.toStdString(), seed),
+        createAgent<Game>(settings.second.toStdString(), seed + 1)
+    };
+
+    Game game;
+    std::mt19937 generator(seed);
+
+    while (!game.isGameOver()) {
+        int player = game.moveCount() % 2;
+        int column;
+
+        if (game.moveCount() < settings.openingMoves) {
+            // Random opening moves, so deterministic players play different games.
+            do {
+                column = std::uniform_int_distribution<int>(0, Game::Columns - 1)(generator);
+            } while (!game.canPlay(column));
+        } else {
+            column = players[player]->chooseMove(game);
+        }
+
+        result.moveList.append(char('1' + column));
+        if (game.play(column) == Game::WON) {
+            result.winner = player + 1;
+        }
+    }
+
+    result.moves = game.moveCount();
+    result.nanoseconds = timer.nsecsElapsed();
+}
+
+// Plays all games, a job each. Deep alpha-beta players split their moves
+// into jobs of their own.
+template <typename Game>
+static void playGames(const Settings &settings, QVector<GameResult> &results)
+{
+    JobSystem::instance().parallelFor("game", 0, settings.games, 1, [&](int i) {
+        playGame<Game>(settings, i, results[i]);
+    });
+}
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_selfplay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Plays Connect 4 games between computer players.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"games", "Number of games to play.", "n", "100"},
+        {"board", "Board variant: 7x6, 8x7, 9x7 or 9x6x5 (five in a row).", "variant", "7x6"},
+        {"first", "Player that moves first: random, heuristic or alphabeta:<depth>.", "agent", "heuristic"},
+        {"second", "Player that moves second.", "agent", "random"},
+        {"threads", "Number of worker threads, 0 for one per core.", "n", "0"},
+        {"opening", "Number of random moves at the start of every game.", "n", "0"},
+        {"seed", "Seed for the random players and openings.", "n", "1"},
+        {"format", "Output format: json or csv.", "format", "json"},
+        {"output", "Write the results to a file instead of stdout.", "file"},
+        {"records", "Also write all games to a game record archive.", "file"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    if (!checkInteger(parser, "games", 1, err) || !checkInteger(parser, "opening", 0, err) ||
+        !checkInteger(parser, "threads", 0, err)) {
+        return 1;
+    }
+
+    Settings settings;
+    settings.first = parser.value("first");
+    settings.second = parser.value("second");
+    settings.games = parser.value("games").toInt();
+    settings.openingMoves = parser.value("opening").toInt();
+    settings.seed = parser.value("seed").toUInt();
+
+    for (const QString &spec : {settings.first, settings.second}) {
+        if (!createAgent<BitBoard>(spec.toStdString(), 0)) {
+            err << "Unknown agent: " << spec << Qt::endl;
+            return 1;
+        }
+    }
+
+    QString format = parser.value("format");
+    if (format != "json" && format != "csv") {
+        err << "Unknown format: " << format << Qt::endl;
+        return 1;
+    }
+
+    QString board = parser.value("board");
+    void (*play)(const Settings &, QVector<GameResult> &) = nullptr;
+    if (board == "7x6") {
+        play = playGames<Board<7, 6, 4>>;
+    } else if (board == "8x7") {
+        play = playGames<Board<8, 7, 4>>;
+    } else if (board == "9x7") {
+        play = playGames<Board<9, 7, 4>>;
+    } else if (board == "9x6x5") {
+        play = playGames<Board<9, 6, 5>>;
+    } else {
+        err << "Unknown board: " << board << Qt::endl;
+        return 1;
+    }
+
+    JobSystem jobs(parser.value("threads").toInt());
+    int threads = jobs.threadCount();
+
+    // Play all games
+    QVector<GameResult> results(settings.games);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    play(settings, results);
+
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    // Aggregate
+    qint64 totalMoves = 0;
+    int wins[3] = {0, 0, 0};
+    for (const GameResult &result : results) {
+        totalMoves += result.moves;
+        wins[result.winner] += 1;
+    }
+    double gamesPerSecond = seconds > 0 ? settings.games / seconds : 0;
+    double movesPerSecond = seconds > 0 ? totalMoves / seconds : 0;
+
+    // Write the games
+    if (parser.isSet("records")) {
+        std::ofstream recordFile(parser.value("records").toLocal8Bit().constData(), std::ios::binary | std::ios::trunc);
+        GameRecordWriter writer(recordFile);
+
+        GameRecord record;
+        const QStringList size = board.split('x');
+        record.columns = size.value(0).toInt();
+        record.rows = size.value(1).toInt();
+        record.inARow = size.value(2, "4").toInt();
+
+        static const uint8_t resultForWinner[3] = {GameRecord::DRAW, GameRecord::FIRST_WON, GameRecord::SECOND_WON};
+        for (const GameResult &result : results) {
+            record.result = resultForWinner[result.winner];
+            record.moves.clear();
+            for (char move : result.moveList) {
+                record.moves.push_back(move - '1');
+            }
+            writer.write(record);
+        }
+
+        if (writer.hasError()) {
+            err << "Cannot write to " << parser.value("records") << Qt::endl;
+            return 1;
+        }
+    }
+
+    // Write the report
+    QFile file;
+    if (parser.isSet("output")) {
+        file.setFileName(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err << "Cannot write to " << file.fileName() << Qt::endl;
+            return 1;
+        }
+    } else {
+        file.open(stdout, QIODevice::WriteOnly);
+    }
+    QTextStream out(&file);
+
+    if (format == "json") {
+        QJsonArray games;
+        for (int i = 0; i < results.size(); i++) {
+            games.append(QJsonObject{
+                {"game", i},
+                {"winner", results[i].winner},
+                {"moves", results[i].moves},
+                {"microseconds", results[i].nanoseconds / 1000.0},
+                {"moveList", QString::fromLatin1(results[i].moveList)},
+            });
+        }
+
+        QJsonObject report{
+            {"board", board},
+            {"first", settings.first},
+            {"second", settings.second},
+            {"threads", threads},
+            {"seed", double(settings.seed)},
+            {"games", games},
+            {"summary", QJsonObject{
+                {"games", settings.games},
+                {"moves", double(totalMoves)},
+                {"firstWins", wins[1]},
+                {"secondWins", wins[2]},
+                {"draws", wins[0]},
+                {"seconds", seconds},
+                {"gamesPerSecond", gamesPerSecond},
+                {"movesPerSecond", movesPerSecond},
+            }},
+        };
+        out << QJsonDocument(report).toJson();
+    } else {
+        out << "game,winner,moves,microseconds,moveList\n";
+        for (int i = 0; i < results.size(); i++) {
+            out << i << ',' << results[i].winner << ',' << results[i].moves << ','
+                << results[i].nanoseconds / 1000.0 << ',' << results[i].moveList << '\n';
+        }
+
+        out << "\nboard,first,second,threads,games,moves,firstWins,secondWins,draws,seconds,gamesPerSecond,movesPerSecond\n";
+        out << board << ',' << settings.first << ',' << settings.second << ',' << threads << ',' << settings.games << ','
+            << totalMoves << ',' << wins[1] << ',' << wins[2] << ',' << wins[0] << ','
+            << seconds << ',' << gamesPerSecond << ',' << movesPerSecond << '\n';
+    }
+
+    return 0;
+}
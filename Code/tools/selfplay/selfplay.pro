@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Headless self-play tournament runner
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = connect4_selfplay
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../../engine.pri)
@@ -0,0 +1,92 @@
+#ifndef GAMEPOOL_H
+#define GAMEPOOL_H
+
+#include "board.h"
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief The GamePool class
+ *
+ * All boards of the server in one preallocated array. Free slots form a
+ * linked list, so creating and releasing a game never allocates.
+ *
+ * A handle holds the slot index in its low 24 bits and the generation of
+ * the slot in its high 8 bits. The generation changes whenever a slot is
+ * released, so a stale handle does not find the game that reused its slot.
+ * Handle 0 is never valid.
+ */
+class GamePool
+{
+public:
+    explicit GamePool(int capacity)
+        : slots(capacity < MaxCapacity ? capacity : MaxCapacity)
+    {
+        for (int i = 0; i < int(slots.size()); i++) {
+            slots[i].nextFree = i + 1 < int(slots.size()) ? i + 1 : -1;
+        }
+        firstFree = slots.empty() ? -1 : 0;
+    }
+
+    // Returns the handle of a new game, or 0 when the pool is full.
+    quint32 create()
+    {
+        if (firstFree < 0) return 0;
+
+        int index = firstFree;
+        Slot &slot = slots[index];
+        firstFree = slot.nextFree;
+        slot.nextFree = InUse;
+        slot.board.clear();
+        used++;
+        return quint32(index) | (quint32(slot.generation) << IndexBits);
+    }
+
+    // Returns the game of a handle, or nullptr if it is not in use.
+    BitBoard *find(quint32 handle)
+    {
+        quint32 index = handle & IndexMask;
+        if (index >= slots.size()) return nullptr;
+
+        Slot &slot = slots[index];
+        if (slot.nextFree != InUse || slot.generation != handle >> IndexBits) return nullptr;
+        return &slot.board;
+    }
+
+    bool release(quint32 handle)
+    {
+        if (!find(handle)) return false;
+
+        int index = int(handle & IndexMask);
+        Slot &slot = slots[index];
+        // Skip generation 0, so no handle is ever 0.
+        slot.generation = slot.generation == 0xFF ? 1 : slot.generation + 1;
+        slot.nextFree = firstFree;
+        firstFree = index;
+        used--;
+        return true;
+    }
+
+    int size() const { return used; }
+    int capacity() const { return int(slots.size()); }
+
+private:
+    static const int IndexBits = 24;
+    static const quint32 IndexMask = (1u << IndexBits) - 1;
+    static const int MaxCapacity = 1 << IndexBits;
+    static const int InUse = -2;
+
+    struct Slot
+    {
+        BitBoard board;
+        quint8 generation = 1;
+        int nextFree = -1;
+    };
+
+    std::vector<Slot> slots;
+    int firstFree = -1;
+    int used = 0;
+};
+
+#endif // GAMEPOOL_H
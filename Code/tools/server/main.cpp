@@ -0,0 +1,202 @@
+#include "board.h"
+#include "gamepool.h"
+#include "protocol.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSet>
+#include <QTextStream>
+#include <QTimer>
+
+/**
+ * Game server for many concurrent matches.
+ *
+ * Hosts any number of independent boards behind a local socket (a Unix
+ * domain socket or a named pipe, no network). All connections are served
+ * from one event loop, the games live in a GamePool. See protocol.h for
+ * the messages.
+ *
+ *   connect4_server --name connect4 --capacity 100000
+ */
+
+class GameServer
+{
+public:
+    GameServer(int capacity)
+        : pool(capacity)
+    {
+        QObject::connect(&server, &QLocalServer::newConnection, [this]() { acceptConnections(); });
+    }
+
+    bool listen(const QString &name)
+    {
+        // Remove a socket file left behind by a server that crashed.
+        QLocalServer::removeServer(name);
+        return server.listen(name);
+    }
+
+    QString errorString() const { return server.errorString(); }
+    QString fullServerName() const { return server.fullServerName(); }
+
+    int sessionCount() const { return pool.size(); }
+    int connectionCount() const { return sessions.size(); }
+    qint64 takeMoveCount() { qint64 count = moves; moves = 0; return count; }
+
+private:
+    void acceptConnections()
+    {
+        while (QLocalSocket *socket = server.nextPendingConnection()) {
+            sessions.insert(socket, QSet<quint32>());
+            QObject::connect(socket, &QLocalSocket::readyRead, [this, socket]() { handleRequests(socket); });
+            QObject::connect(socket, &QLocalSocket::disconnected, [this, socket]() { closeConnection(socket); });
+        }
+    }
+
+    void closeConnection(QLocalSocket *socket)
+    {
+        for (quint32 session : sessions.value(socket)) {
+            pool.release(session);
+        }
+        sessions.remove(socket);
+        pending.remove(socket);
+        socket->deleteLater();
+    }
+
+    // Answers every complete request that has arrived, in one write.
+    void handleRequests(QLocalSocket *socket)
+    {
+        QByteArray &input = pending[socket];
+        input.append(socket->readAll());
+
+        int count = input.size() / Protocol::MessageSize;
+        if (count == 0) return;
+
+        output.resize(count * Protocol::MessageSize);
+        for (int i = 0; i < count; i++) {
+            Protocol::Message message = Protocol::decode(input.constData() + i * Protocol::MessageSize);
+            handleRequest(socket, message);
+            Protocol::encode(message, output.data() + i * Protocol::MessageSize);
+        }
+        input.remove(0, count * Protocol::MessageSize);
+        if (input.isEmpty()) {
+            pending.remove(socket);
+        }
+
+        socket->write(output);
+    }
+
+    // Turns the request into its response.
+    void handleRequest(QLocalSocket *socket, Protocol::Message &message)
+    {
+        message.status = Protocol::OK;
+
+        if (message.type == Protocol::NEW_GAME) {
+            message.session = pool.create();
+            if (message.session == 0) {
+                message.status = Protocol::SERVER_FULL;
+            } else {
+                sessions[socket].insert(message.session);
+            }
+            message.state = BitBoard::UNFINISHED;
+            return;
+        }
+
+        // Handles are easy to guess, a connection only gets at its own sessions.
+        auto owned = sessions.constFind(socket);
+        BitBoard *game = owned != sessions.constEnd() && owned->contains(message.session)
+                ? pool.find(message.session) : nullptr;
+        if (!game) {
+            message.status = Protocol::UNKNOWN_SESSION;
+            return;
+        }
+
+        switch (message.type) {
+            case Protocol::MOVE:
+                if (game->canPlay(message.column)) {
+                    game->play(message.column);
+                    moves++;
+                } else {
+                    message.status = Protocol::ILLEGAL_MOVE;
+                }
+                break;
+            case Protocol::RESET:
+                game->clear();
+                break;
+            case Protocol::CLOSE:
+                pool.release(message.session);
+                sessions[socket].remove(message.session);
+                message.state = BitBoard::UNFINISHED;
+                return;
+            default:
+                message.status = Protocol::BAD_REQUEST;
+                break;
+        }
+        message.state = quint8(game->state());
+    }
+
+    QLocalServer server;
+    GamePool pool;
+    QHash<QLocalSocket *, QSet<quint32>> sessions;  // Sessions created by each connection
+    QHash<QLocalSocket *, QByteArray> pending;      // Partial requests
+    QByteArray output;
+    qint64 moves = 0;
+};
+
+// False, after saying why, unless every comma separated value of the
+// option is a whole number of at least minimum.
+static bool checkInteger(const QCommandLineParser &parser, const QString &option, qlonglong minimum, QTextStream &err)
+{
+    for (const QString &value : parser.value(option).split(',')) {
+        bool ok = false;
+        if (value.toLongLong(&ok) < minimum || !ok) {
+            err << "--" << option << " must be a whole number of at least " << minimum << ", not " << value << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("connect4_server");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Hosts many Connect 4 games behind a local socket.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"name", "Name of the local socket.", "name", Protocol::DefaultServerName},
+        {"capacity", "Maximum number of concurrent games.", "n", "1048576"},
+        {"stats", "Print the number of sessions and moves every second."},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (!checkInteger(parser, "capacity", 1, err)) return 1;
+
+    GameServer server(parser.value("capacity").toInt());
+    if (!server.listen(parser.value("name"))) {
+        out << "Cannot listen on " << parser.value("name") << ": " << server.errorString() << Qt::endl;
+        return 1;
+    }
+    out << "Listening on " << server.fullServerName() << Qt::endl;
+
+    QTimer statsTimer;
+    QElapsedTimer elapsed;
+    if (parser.isSet("stats")) {
+        elapsed.start();
+        QObject::connect(&statsTimer, &QTimer::timeout, [&]() {
+            double seconds = elapsed.restart() / 1000.0;
+            out << server.connectionCount() << " connections, " << server.sessionCount() << " sessions, "
+                << server.takeMoveCount() / seconds << " moves/s" << Qt::endl;
+        });
+        statsTimer.start(1000);
+    }
+
+    return app.exec();
+}
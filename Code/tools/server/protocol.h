@@ -0,0 +1,75 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <QtGlobal>
+
+/**
+ * The binary protocol of connect4_server.
+ *
+ * Every request and every response is one 8 byte message:
+ *
+ *   byte 0     MessageType
+ *   byte 1     column (0 indexed) for MOVE
+ *   byte 2     Status, responses only
+ *   byte 3     game state after the request (Board::GameState), responses only
+ *   byte 4-7   session handle, little endian
+ *
+ * A connection can play any number of sessions at the same time, but only
+ * the sessions it created: the handle of another connection's session is
+ * an UNKNOWN_SESSION. The server answers the requests of a connection in the order they arrive,
+ * echoing the type and column of the request.
+ */
+namespace Protocol {
+
+const char DefaultServerName[] = "connect4";
+const int MessageSize = 8;
+
+enum MessageType : quint8
+{
+    NEW_GAME = 1,   // Creates a session, the response holds its handle
+    MOVE,           // Drops a disk for the player to move
+    RESET,          // Empties the board of a session
+    CLOSE           // Ends a session
+};
+
+enum Status : quint8
+{
+    OK = 0, ILLEGAL_MOVE, UNKNOWN_SESSION, SERVER_FULL, BAD_REQUEST
+};
+
+struct Message
+{
+    quint8 type = 0;
+    quint8 column = 0;
+    quint8 status = OK;
+    quint8 state = 0;
+    quint32 session = 0;
+};
+
+inline void encode(const Message &message, char *out)
+{
+    out[0] = char(message.type);
+    out[1] = char(message.column);
+    out[2] = char(message.status);
+    out[3] = char(message.state);
+    for (int i = 0; i < 4; i++) {
+        out[4 + i] = char((message.session >> (8 * i)) & 0xFF);
+    }
+}
+
+inline Message decode(const char *in)
+{
+    Message message;
+    message.type = quint8(in[0]);
+    message.column = quint8(in[1]);
+    message.status = quint8(in[2]);
+    message.state = quint8(in[3]);
+    for (int i = 0; i < 4; i++) {
+        message.session |= quint32(quint8(in[4 + i])) << (8 * i);
+    }
+    return message;
+}
+
+}
+
+#endif // PROTOCOL_H
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Game server for many concurrent matches
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = connect4_server
+TEMPLATE = app
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+HEADERS += protocol.h \
+    gamepool.h
+
+include(../../engine.pri)
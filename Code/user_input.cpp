@@ -1,19 +1,32 @@
 #include "mainview.h"
+#include "eventlog.h"
 
 #include <QDebug>
 
 // Triggered by pressing a key
 void MainView::keyPressEvent(QKeyEvent *ev)
 {
-    if(ev->key() >= 49 && ev->key() <= 55){
+    latency.inputReceived();
+
+    if (ev->matches(QKeySequence::Undo) || ev->key() == Qt::Key_Backspace) {
+        undoMove();
+    } else if (ev->matches(QKeySequence::Redo)) {
+        redoMove();
+    } else if(ev->key() >= 49 && ev->key() < 49 + GameBoard::Columns){
         dropDisk(ev->key() - 48);
     } else if (ev->key() == 48 || ev->key() == 82){
-        qDebug() << "The board has been reset.";
+        EventLog::info("The board has been reset.");
         clearBoard();
+    } else if (ev->key() == Qt::Key_P) {
+        setProfiling(!renderer.profiler().isEnabled());
+    } else if (ev->key() == Qt::Key_F9) {
+        toggleCapture();
+    } else if (ev->key() == Qt::Key_F12) {
+        dumpProfile();
     }
 
     // Used to update the screen after changes
-    update();
+    showInput();
 }
 
 // Triggered by releasing a key
@@ -35,15 +48,16 @@ void MainView::keyReleaseEvent(QKeyEvent *ev)
 // It also fires two mousePress and mouseRelease events!
 void MainView::mouseDoubleClickEvent(QMouseEvent *ev)
 {
+    Q_UNUSED(ev);
     //qDebug() << "Mouse double clicked:" << ev->button();
 
     update();
 }
 
-// Triggered when moving the mouse inside the window (only when the mouse is clicked!)
+// Triggered when moving the mouse inside the window, mouse tracking is on
 void MainView::mouseMoveEvent(QMouseEvent *ev)
 {
-    //qDebug() << "x" << ev->x() << "y" << ev->y();
+    game.setHoverColumn(columnAt(ev->pos()));
 
     update();
 }
@@ -51,9 +65,16 @@ void MainView::mouseMoveEvent(QMouseEvent *ev)
 // Triggered when pressing any mouse button
 void MainView::mousePressEvent(QMouseEvent *ev)
 {
-    qDebug() << "You have selected the game.";
+    EventLog::debug("You have selected the game.");
 
-    update();
+    // Clicking a column drops a disk in it.
+    if (ev->button() == Qt::LeftButton) {
+        latency.inputReceived();
+        int column = columnAt(ev->pos());
+        if (column > 0) dropDisk(column);
+    }
+
+    showInput();
     // Do not remove the line below, clicking must focus on this widget!
     this->setFocus();
 }
@@ -61,6 +82,7 @@ void MainView::mousePressEvent(QMouseEvent *ev)
 // Triggered when releasing any mouse button
 void MainView::mouseReleaseEvent(QMouseEvent *ev)
 {
+    Q_UNUSED(ev);
     //qDebug() << "Mouse button released" << ev->button();
 
     update();
@@ -69,8 +91,18 @@ void MainView::mouseReleaseEvent(QMouseEvent *ev)
 // Triggered when clicking scrolling with the scroll wheel on the mouse
 void MainView::wheelEvent(QWheelEvent *ev)
 {
+    Q_UNUSED(ev);
     // Implement something
     //qDebug() << "Mouse wheel:" << ev->delta();
 
     update();
 }
+
+// Triggered when the mouse leaves the window
+void MainView::leaveEvent(QEvent *ev)
+{
+    Q_UNUSED(ev);
+    game.setHoverColumn(0);
+
+    update();
+}
@@ -1,29 +0,0 @@
-#include "mainview.h"
-
-QVector<quint8> MainView::imageToBytes(QImage image) {
-    // needed since (0,0) is bottom left in OpenGL
-    QImage im = image.mirrored();
-    QVector<quint8> pixelData;
-    pixelData.reserve(im.width()*im.height()*4);
-
-    for (int i = 0; i != im.height(); ++i) {
-        for (int j = 0; j != im.width(); ++j) {
-            QRgb pixel = im.pixel(j,i);
-
-            // pixel is of format #AARRGGBB (in hexadecimal notation)
-            // so with bitshifting and binary AND you can get
-            // the values of the different components
-            quint8 r = (quint8)((pixel >> 16) & 0xFF); // Red component
-            quint8 g = (quint8)((pixel >> 8) & 0xFF); // Green component
-            quint8 b = (quint8)(pixel & 0xFF); // Blue component
-            quint8 a = (quint8)((pixel >> 24) & 0xFF); // Alpha component
-
-            // Add them to the Vector
-            pixelData.append(r);
-            pixelData.append(g);
-            pixelData.append(b);
-            pixelData.append(a);
-        }
-    }
-    return pixelData;
-}